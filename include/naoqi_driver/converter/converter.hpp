@@ -71,6 +71,14 @@ public:
     return convPtr_->frequency();
   }
 
+  /**
+  * @brief change the frequency at which the converter is scheduled
+  */
+  void setFrequency( float frequency )
+  {
+    convPtr_->setFrequency( frequency );
+  }
+
   void reset()
   {
     convPtr_->reset();
@@ -114,6 +122,7 @@ private:
     virtual ~ConverterConcept(){}
     virtual std::string name() const = 0;
     virtual float frequency() const = 0;
+    virtual void setFrequency( float frequency ) = 0;
     virtual void reset() = 0;
     virtual void callAll( const std::vector<message_actions::MessageAction>& actions ) = 0;
   };
@@ -138,6 +147,11 @@ private:
     {
       return converter_->frequency();
     }
+
+    void setFrequency( float frequency )
+    {
+      converter_->setFrequency( frequency );
+    }
     
     void reset()
     {
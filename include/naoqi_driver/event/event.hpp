@@ -74,6 +74,15 @@ public:
     eventPtr_->stopProcess();
   }
 
+  /**
+  * @brief resolve the proxies again and restore the robot side subscriptions,
+  * once the session reconnected
+  */
+  void reconnect( )
+  {
+    eventPtr_->reconnect();
+  }
+
   void writeDump( const rclcpp::Time& time )
   {
     eventPtr_->writeDump(time);
@@ -111,6 +120,7 @@ private:
     virtual void resetRecorder(boost::shared_ptr<naoqi::recorder::GlobalRecorder> gr) = 0;
     virtual void startProcess() = 0;
     virtual void stopProcess() = 0;
+    virtual void reconnect() = 0;
     virtual void writeDump(const rclcpp::Time& time) = 0;
     virtual void setBufferDuration(float duration) = 0;
     virtual void isRecording(bool state) = 0;
@@ -149,6 +159,11 @@ private:
       converter_->stopProcess();
     }
 
+    void reconnect( )
+    {
+      converter_->reconnect();
+    }
+
     void writeDump( const rclcpp::Time& time )
     {
       converter_->writeDump(time);
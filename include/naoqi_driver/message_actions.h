@@ -13,6 +13,9 @@ enum MessageAction
   LOG
 };
 
+/** number of actions, to index tables by action */
+static const int MESSAGE_ACTION_COUNT = LOG + 1;
+
 }
 
 }
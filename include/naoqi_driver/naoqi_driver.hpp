@@ -19,14 +19,17 @@
 #ifndef NAOQI_DRIVER_HPP
 #define NAOQI_DRIVER_HPP
 
+#include <atomic>
 #include <vector>
 #include <queue>
 
 /*
 * BOOST
 */
+#include <boost/function.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
 
 /*
 * ALDEB
@@ -44,9 +47,9 @@
 #include <naoqi_driver/event/event.hpp>
 #include <naoqi_driver/recorder/globalrecorder.hpp>
 
-namespace tf2_ros
+namespace rclcpp_action
 {
-  class Buffer;
+  class ServerBase;
 }
 
 namespace naoqi
@@ -56,6 +59,19 @@ namespace recorder
 {
   class GlobalRecorder;
 }
+
+namespace converter
+{
+  class CameraConverter;
+  class LazyConverter;
+}
+
+namespace tools
+{
+  class ClockSync;
+  class PoseCache;
+  class TransformCache;
+}
 /**
 * @brief Interface for naoqi driver which is registered as a naoqi2 Module,
 * once the external roscore ip is set, this class will advertise and publish ros messages
@@ -66,8 +82,9 @@ public:
   /**
    * @brief Constructor for the naoqi driver
    *
+   * @param options node options, e.g. given by a component container
    */
-  Driver();
+  Driver( const rclcpp::NodeOptions& options = rclcpp::NodeOptions() );
 
   /**
   * @brief Destructor for naoqi driver,
@@ -80,12 +97,37 @@ public:
    */
   void run();
 
+  /**
+   * @brief Register the ROS components, without starting the ROS loop.
+   */
+  void init();
+
+  /**
+   * @brief Run one iteration of the ROS loop, after reconnecting the session if it was lost.
+   */
+  void spinOnce();
+
   /**
    * @brief Set the Session object
    *
    */
   void setQiSession(const qi::SessionPtr& session_ptr);
 
+  /**
+   * @brief Connect the session to the robot given by the node parameters
+   * (nao_ip, nao_port, user, password, qi_listen_url), then set it
+   * @return false if the connection failed
+   */
+  bool connectQiSession(const qi::SessionPtr& session_ptr);
+
+  /**
+   * @brief Leave the spinning of the node to the executor it was added to,
+   * in a component container, instead of the ROS loop. The ROS loop
+   * iterations do not wait for the next converter then, spinOnce is
+   * expected to be called again by a timer of the executor.
+   */
+  void disableSpinning();
+
   void stop();
   /**
    * @brief Write a ROSbag with the last bufferized data (10s by default)
@@ -244,6 +286,7 @@ private:
   bool log_enabled_;
   bool keep_looping;
   bool has_stereo;
+  bool spin_node_;
 
   const size_t freq_;
 
@@ -254,6 +297,28 @@ private:
   void loadBootConfig();
 
   void registerDefaultConverter();
+
+  /**
+   * @brief register a converter built by the factory, or on its first
+   * consumer only when lazy converters are enabled
+   */
+  void registerLazyConverter( const std::string& name, float frequency,
+                              const boost::function<converter::Converter()>& factory,
+                              publisher::Publisher pub, recorder::Recorder rec );
+
+  /**
+   * @brief expose the frequency and enable state of the registered converters,
+   * and the resolution of the cameras, as parameters which can be set at runtime
+   */
+  void declareConverterParameters();
+  rcl_interfaces::msg::SetParametersResult onConverterParametersSet( const std::vector<rclcpp::Parameter>& parameters );
+
+  /**
+   * @brief schedule a converter again from now, its pending tick is dropped
+   * @note mutex_conv_queue_ has to be locked
+   */
+  void rescheduleConverter( size_t conv_index );
+
   void registerDefaultSubscriber();
   void registerDefaultServices();
   void insertEventConverter(const std::string& key, event::Event event);
@@ -271,6 +336,14 @@ private:
 
   void rosIteration();
 
+  /**
+   * @brief reconnect the session with a growing delay between attempts,
+   * then resolve the proxies again and restore the robot side subscriptions
+   * of the converters, subscribers and events. The ROS side is left untouched.
+   */
+  void reconnectSession();
+  void onSessionDisconnected( const std::string& reason );
+
   boost::mutex mutex_conv_queue_;
   boost::mutex mutex_record_;
 
@@ -287,13 +360,15 @@ private:
 
   std::vector< subscriber::Subscriber > subscribers_;
   std::vector< service::Service > services_;
+  std::vector< std::shared_ptr<rclcpp_action::ServerBase> > action_servers_;
+  rclcpp::PublisherBase::SharedPtr robot_description_pub_;
 
   float buffer_duration_;
 
   /** Pub Publisher to execute at a specific time */
   struct ScheduledConverter {
-    ScheduledConverter(const rclcpp::Time& schedule, size_t conv_index) :
-       schedule_(schedule), conv_index_(conv_index)
+    ScheduledConverter(const rclcpp::Time& schedule, size_t conv_index, size_t generation=0) :
+       schedule_(schedule), conv_index_(conv_index), generation_(generation)
     {
     }
 
@@ -304,15 +379,46 @@ private:
     rclcpp::Time schedule_;
     /** Time at which the publisher will be called */
     size_t conv_index_;
+    /** Ticks of an older generation than the converter's one are dropped */
+    size_t generation_;
   };
 
   /** Priority queue to process the publishers according to their frequency */
   std::priority_queue<ScheduledConverter> conv_queue_;
+  /** Generation of the scheduled ticks and enable state, by converter index */
+  std::vector<size_t> conv_generations_;
+  std::vector<bool> conv_enabled_;
 
-  /** tf2 buffer that will be shared between different publishers/subscribers
-   * This is only for performance improvements
+  /** cameras whose resolution can be changed through their parameter */
+  std::map< std::string, int > camera_resolutions_;
+  std::map< std::string, boost::weak_ptr<converter::CameraConverter> > camera_converters_;
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr converter_parameters_callback_;
+
+  /** transforms of the joint states ticks needed by the subscribers,
+   * only the frame pairs they registered are kept
    */
-  boost::shared_ptr<tf2_ros::Buffer> tf2_buffer_;
+  boost::shared_ptr<tools::TransformCache> transform_cache_;
+
+  /** estimation of the robot clocks, to stamp messages with the sampling time */
+  boost::shared_ptr<tools::ClockSync> clock_sync_;
+
+  /** DCM/Time mapping: clock_sync_, or an offset latched once when it is disabled */
+  boost::shared_ptr<tools::ClockSync> dcm_clock_;
+
+  /** torso pose shared between the joint states and odometry converters */
+  boost::shared_ptr<tools::PoseCache> pose_cache_;
+
+  /** session loss detection and reconnection */
+  qi::Url session_url_;
+  std::atomic<bool> session_lost_;
+  bool reconnect_enabled_;
+  float reconnect_min_delay_;
+  float reconnect_max_delay_;
+
+  /** converters built on their first consumer, released when idle */
+  bool lazy_converters_enabled_;
+  float lazy_idle_timeout_;
+  std::map< std::string, boost::shared_ptr<converter::LazyConverter> > lazy_converters_;
 };
 
 } // naoqi
@@ -19,8 +19,14 @@
 #ifndef HELPERS_HPP
 #define HELPERS_HPP
 
+#include <atomic>
+#include <map>
+#include <memory>
+
 #include <rclcpp/rclcpp.hpp>
+#include <boost/property_tree/ptree.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace naoqi {
 namespace helpers {
@@ -38,6 +44,8 @@ public:
    */
   static void setNode(const boost::shared_ptr<rclcpp::Node>& node_ptr) {
     Node::node_ptr_ = node_ptr;
+    // set by the graph listener of the node on each change
+    Node::graph_event_ = node_ptr->get_graph_event();
   }
 
   /**
@@ -58,10 +66,80 @@ public:
     return Node::node_ptr_->count_subscribers(topic_name);
   }
 
+  /**
+   * @brief Get the number of subscribers on a topic, counted again only when
+   * the ROS graph changed, so publishers can check it on each tick
+   * 
+   * @return counter shared by the publishers of this topic, read after
+   * refresh_subscribers
+   */
+  static boost::shared_ptr<const std::atomic<size_t> > watch_subscribers(const std::string& topic_name);
+
+  /**
+   * @brief Count the subscribers of the watched topics again if the graph
+   * changed since the last call, only a flag is read otherwise
+   */
+  static void refresh_subscribers();
+
+  /**
+   * @brief Set the QoS overrides, by topic name, read from the boot config
+   * 
+   * @param config the "qos" section of the boot config
+   */
+  static void setQoSConfig(const boost::property_tree::ptree& config) {
+    Node::qos_config_ = config;
+  }
+
+  /**
+   * @brief Get the QoS of a topic, the default one with the fields set in
+   * the boot config for this topic (reliability, durability, depth,
+   * deadline and lifespan) overridden
+   * 
+   * @return rclcpp::QoS 
+   */
+  static rclcpp::QoS qos(const std::string& topic_name, const rclcpp::QoS& default_qos);
+
+  /**
+   * @brief Get the options of a publisher with this QoS, intra-process
+   * communication is only used for volatile topics, it does not support
+   * the latched ones
+   * 
+   * @return rclcpp::PublisherOptions 
+   */
+  static rclcpp::PublisherOptions publisher_options(const rclcpp::QoS& qos) {
+    rclcpp::PublisherOptions options;
+    if (qos.durability() != rclcpp::DurabilityPolicy::Volatile) {
+      options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    }
+    return options;
+  }
+
 protected:
   static boost::shared_ptr<rclcpp::Node> node_ptr_;
+  static boost::property_tree::ptree qos_config_;
+
+  static boost::mutex watched_mutex_;
+  static rclcpp::Event::SharedPtr graph_event_;
+  static std::map<std::string, boost::shared_ptr<std::atomic<size_t> > > watched_topics_;
 };
 
+/**
+ * @brief Publish a message kept by its converter, copied once: into memory
+ * loaned by the middleware when it can loan this type (shared memory
+ * transports, plain types only), so that it is not serialized, or into a
+ * new message handed over to the intra-process subscriptions otherwise
+ */
+template <typename T>
+void publishCopy(rclcpp::Publisher<T>& publisher, const T& msg) {
+  if (publisher.can_loan_messages()) {
+    rclcpp::LoanedMessage<T> loaned_msg = publisher.borrow_loaned_message();
+    loaned_msg.get() = msg;
+    publisher.publish(std::move(loaned_msg));
+  } else {
+    publisher.publish(std::make_unique<T>(msg));
+  }
+}
+
 /**
  * @brief Time helper class, used to access to time related functionalities 
  * throughout the project
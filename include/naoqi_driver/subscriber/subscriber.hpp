@@ -72,6 +72,15 @@ public:
     std::cout << name() << " reset" << std::endl;
   }
 
+  /**
+  * @brief resolve the proxies again once the session reconnected,
+  * the ROS subscription is kept
+  */
+  void reconnect()
+  {
+    subPtr_->reconnect();
+  }
+
   /**
   * @brief getting the descriptive name for this subscriber instance
   * @return string with the name
@@ -108,6 +117,7 @@ private:
     virtual ~SubscriberConcept(){}
     virtual bool isInitialized() const = 0;
     virtual void reset( rclcpp::Node* node ) = 0;
+    virtual void reconnect() = 0;
     virtual std::string name() const = 0;
     virtual std::string topic() const = 0;
   };
@@ -143,6 +153,11 @@ private:
       subscriber_->reset( node );
     }
 
+    void reconnect()
+    {
+      subscriber_->reconnect();
+    }
+
     T subscriber_;
   };
 
@@ -0,0 +1,60 @@
+import launch
+import launch_ros
+import launch.actions
+import launch.substitutions
+import launch_ros.actions
+import launch_ros.descriptions
+
+def generate_launch_description():
+    return launch.LaunchDescription([
+        launch.actions.DeclareLaunchArgument(
+            'nao_ip',
+            default_value="127.0.0.1",
+            description='Ip address of the robot'),
+        launch.actions.DeclareLaunchArgument(
+            'nao_port',
+            default_value="9559",
+            description='Port to be used for the connection'),
+        launch.actions.DeclareLaunchArgument(
+            'username',
+            default_value="nao",
+            description='Username for the connection'),
+        launch.actions.DeclareLaunchArgument(
+            'password',
+            default_value="no_password",
+            description='Password for the connection'),
+        launch.actions.DeclareLaunchArgument(
+            'network_interface',
+            default_value="eth0",
+            description='Network interface to be used'),
+        launch.actions.DeclareLaunchArgument(
+            'qi_listen_url',
+            default_value="tcp://0.0.0.0:0",
+            description='Endpoint to listen for incoming NAOqi connections (for audio)'),
+        launch.actions.DeclareLaunchArgument(
+            'namespace',
+            default_value="naoqi_driver",
+            description='Name of the namespace to be used'),
+        launch_ros.actions.ComposableNodeContainer(
+            name='naoqi_driver_container',
+            namespace='',
+            package='rclcpp_components',
+            executable='component_container_mt',
+            composable_node_descriptions=[
+                launch_ros.descriptions.ComposableNode(
+                    package='naoqi_driver',
+                    plugin='naoqi::DriverComponent',
+                    name='naoqi_driver',
+                    parameters=[{
+                        'nao_ip': launch.substitutions.LaunchConfiguration('nao_ip'),
+                        'nao_port': launch.substitutions.LaunchConfiguration('nao_port'),
+                        'user': launch.substitutions.LaunchConfiguration('username'),
+                        'password': launch.substitutions.LaunchConfiguration('password'),
+                        'network_interface': launch.substitutions.LaunchConfiguration('network_interface'),
+                        'qi_listen_url': launch.substitutions.LaunchConfiguration('qi_listen_url'),
+                    }],
+                    # perception components loaded in this container get the images without serialization
+                    extra_arguments=[{'use_intra_process_comms': True}]),
+            ],
+            output="screen")
+    ])
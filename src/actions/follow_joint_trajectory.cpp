@@ -0,0 +1,265 @@
+#include "follow_joint_trajectory.hpp"
+#include "../helpers/driver_helpers.hpp"
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using FollowJointTrajectory = control_msgs::action::FollowJointTrajectory;
+using FollowJointTrajectoryGoalHandle = rclcpp_action::ServerGoalHandle<FollowJointTrajectory>;
+
+namespace naoqi
+{
+namespace action
+{
+namespace
+{
+  // Rate at which the joints are sampled for the feedback
+  const double kFeedbackRate = 10.0;
+
+  struct FollowJointTrajectoryState {
+    FollowJointTrajectoryState(rclcpp::Node* node, qi::SessionPtr session) :
+      node(node),
+      session(std::move(session))
+    {}
+
+    rclcpp::Node* node;
+    qi::SessionPtr session;
+    rclcpp::Logger logger = node->get_logger();
+    std::mutex mutex;
+    std::shared_ptr<FollowJointTrajectoryGoalHandle> current_goal;
+  };
+
+  double toSeconds(const builtin_interfaces::msg::Duration& duration)
+  {
+    return duration.sec + duration.nanosec * 1e-9;
+  }
+
+  // A first point at time 0 is the current state, as sent by MoveIt or
+  // joint_trajectory_controller clients: it is not given to angleInterpolation
+  bool isStartPoint(const trajectory_msgs::msg::JointTrajectory& trajectory, size_t index)
+  {
+    return index == 0 && toSeconds(trajectory.points[0].time_from_start) == 0.0;
+  }
+
+  // Checks that the trajectory, but its start point, can be given as is to angleInterpolation
+  bool isValid(const trajectory_msgs::msg::JointTrajectory& trajectory, std::string& error)
+  {
+    if (trajectory.joint_names.empty() || trajectory.points.empty())
+    {
+      error = "the trajectory is empty";
+      return false;
+    }
+    double previous_time = 0.0;
+    size_t interpolated_points = 0;
+    for (size_t index = 0; index < trajectory.points.size(); ++index)
+    {
+      const auto& point = trajectory.points[index];
+      if (point.positions.size() != trajectory.joint_names.size())
+      {
+        error = "every point needs a position for each joint";
+        return false;
+      }
+      if (isStartPoint(trajectory, index))
+      {
+        continue;
+      }
+      const double time = toSeconds(point.time_from_start);
+      if (time <= previous_time)
+      {
+        error = "time_from_start must be strictly increasing and positive after the start point";
+        return false;
+      }
+      previous_time = time;
+      ++interpolated_points;
+    }
+    if (interpolated_points == 0)
+    {
+      error = "the trajectory has no point after the start point";
+      return false;
+    }
+    return true;
+  }
+
+  // Position of the trajectory at the given time, linearly interpolated between points
+  std::vector<double> desiredPositions(const trajectory_msgs::msg::JointTrajectory& trajectory, double time)
+  {
+    std::vector<double> previous_positions;
+    double previous_time = 0.0;
+    for (const auto& point: trajectory.points)
+    {
+      const double point_time = toSeconds(point.time_from_start);
+      if (time <= point_time)
+      {
+        if (previous_positions.empty())
+        {
+          return point.positions;
+        }
+        const double ratio = (time - previous_time) / (point_time - previous_time);
+        std::vector<double> positions(point.positions.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+          positions[i] = previous_positions[i] + ratio * (point.positions[i] - previous_positions[i]);
+        }
+        return positions;
+      }
+      previous_positions = point.positions;
+      previous_time = point_time;
+    }
+    return trajectory.points.back().positions;
+  }
+
+  rclcpp_action::GoalResponse handle_goal(
+    std::shared_ptr<FollowJointTrajectoryState> state,
+    const rclcpp_action::GoalUUID & uuid,
+    const std::shared_ptr<const FollowJointTrajectory::Goal> goal)
+  {
+    std::string goal_id = rclcpp_action::to_string(uuid);
+    RCLCPP_INFO(state->logger, "Received trajectory request %s", goal_id.c_str());
+
+    std::string error;
+    if (!isValid(goal->trajectory, error))
+    {
+      RCLCPP_INFO(state->logger, "Rejected trajectory %s: %s", goal_id.c_str(), error.c_str());
+      return rclcpp_action::GoalResponse::REJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (auto current_goal = state->current_goal) {
+      RCLCPP_INFO(
+        state->logger,
+        "Rejected trajectory %s because the robot is already following trajectory %s",
+        goal_id.c_str(),
+        rclcpp_action::to_string(current_goal->get_goal_id()).c_str());
+      return rclcpp_action::GoalResponse::REJECT;
+    }
+
+    RCLCPP_INFO(state->logger, "Accepted trajectory %s", goal_id.c_str());
+    return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+  }
+
+  void execute(
+    std::shared_ptr<FollowJointTrajectoryState> state,
+    const std::shared_ptr<FollowJointTrajectoryGoalHandle> goal_handle)
+  {
+    auto& logger = state->logger;
+    std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
+    const auto& trajectory = goal_handle->get_goal()->trajectory;
+    auto result = std::make_shared<FollowJointTrajectory::Result>();
+    bool started = false;
+
+    try
+    {
+      auto motion = helpers::driver::getService(state->session, "ALMotion");
+
+      // the whole trajectory is a single interpolation on the robot
+      std::vector<std::vector<float> > angle_lists(trajectory.joint_names.size());
+      std::vector<std::vector<float> > time_lists(trajectory.joint_names.size());
+      for (size_t index = 0; index < trajectory.points.size(); ++index)
+      {
+        if (isStartPoint(trajectory, index))
+        {
+          continue;
+        }
+        const auto& point = trajectory.points[index];
+        const float time = toSeconds(point.time_from_start);
+        for (size_t i = 0; i < trajectory.joint_names.size(); ++i)
+        {
+          angle_lists[i].push_back(point.positions[i]);
+          time_lists[i].push_back(time);
+        }
+      }
+
+      RCLCPP_INFO(logger, "Trajectory %s starts", goal_id.c_str());
+      const auto start = std::chrono::steady_clock::now();
+      qi::Future<void> interpolating = motion.async<void>(
+        "angleInterpolation", trajectory.joint_names, angle_lists, time_lists, true);
+      started = true;
+
+      auto feedback = std::make_shared<FollowJointTrajectory::Feedback>();
+      feedback->joint_names = trajectory.joint_names;
+      const int period_ms = static_cast<int>(1000.0 / kFeedbackRate);
+      while (interpolating.wait(period_ms) == qi::FutureState_Running)
+      {
+        if (goal_handle->is_canceling())
+        {
+          motion.call<void>("killTasksUsingResources", trajectory.joint_names);
+          interpolating.wait();
+          RCLCPP_INFO(logger, "Trajectory %s canceled", goal_id.c_str());
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->current_goal.reset();
+          goal_handle->canceled(result);
+          return;
+        }
+
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        feedback->header.stamp = state->node->now();
+        feedback->desired.positions = desiredPositions(trajectory, elapsed);
+        feedback->actual.positions = motion.call<std::vector<double> >("getAngles", trajectory.joint_names, true);
+        feedback->error.positions.resize(feedback->desired.positions.size());
+        for (size_t i = 0; i < feedback->error.positions.size() && i < feedback->actual.positions.size(); ++i)
+        {
+          feedback->error.positions[i] = feedback->desired.positions[i] - feedback->actual.positions[i];
+        }
+        goal_handle->publish_feedback(feedback);
+      }
+
+      // also raises if the interpolation failed
+      interpolating.value();
+      RCLCPP_INFO(logger, "Trajectory %s done", goal_id.c_str());
+      result->error_code = FollowJointTrajectory::Result::SUCCESSFUL;
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->current_goal.reset();
+      goal_handle->succeed(result);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(logger, "Failed to follow trajectory %s: %s", goal_id.c_str(), e.what());
+      // the robot could not take the goal, or did not follow the trajectory until its end
+      result->error_code = started
+        ? FollowJointTrajectory::Result::PATH_TOLERANCE_VIOLATED
+        : FollowJointTrajectory::Result::INVALID_GOAL;
+      result->error_string = e.what();
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->current_goal.reset();
+      goal_handle->abort(result);
+    }
+  }
+
+  void handle_accepted(
+    std::shared_ptr<FollowJointTrajectoryState> state,
+    const std::shared_ptr<FollowJointTrajectoryGoalHandle> goal_handle)
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->current_goal = goal_handle;
+    }
+    // the executor must not wait for the motion
+    std::thread(execute, state, goal_handle).detach();
+  }
+
+  rclcpp_action::CancelResponse handle_cancel(
+    std::shared_ptr<FollowJointTrajectoryState> state,
+    const std::shared_ptr<FollowJointTrajectoryGoalHandle> goal_handle)
+  {
+    std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
+    RCLCPP_INFO(state->logger, "Received trajectory cancellation request %s", goal_id.c_str());
+    // the execution thread stops the motion and sets the canceled state
+    return rclcpp_action::CancelResponse::ACCEPT;
+  }
+}
+
+rclcpp_action::Server<FollowJointTrajectory>::SharedPtr
+createFollowJointTrajectoryServer(rclcpp::Node* node, qi::SessionPtr session)
+{
+  namespace ph = std::placeholders;
+  auto task = std::make_shared<FollowJointTrajectoryState>(node, std::move(session));
+  return rclcpp_action::create_server<FollowJointTrajectory>(
+    node, "follow_joint_trajectory",
+    std::bind(handle_goal, task, ph::_1, ph::_2),
+    std::bind(handle_cancel, task, ph::_1),
+    std::bind(handle_accepted, task, ph::_1)
+  );
+}
+
+} // ends namespace action
+} // ends namespace naoqi
@@ -0,0 +1,13 @@
+#include <rclcpp_action/rclcpp_action.hpp>
+#include <qi/session.hpp>
+#include <control_msgs/action/follow_joint_trajectory.hpp>
+
+namespace naoqi
+{
+namespace action {
+
+rclcpp_action::Server<control_msgs::action::FollowJointTrajectory>::SharedPtr
+createFollowJointTrajectoryServer(rclcpp::Node* node, qi::SessionPtr session);
+
+} // ends namespace action
+} // ends namespace naoqi
@@ -1,5 +1,11 @@
 #include "listen.hpp"
-#include <boost/algorithm/string.hpp>
+#include "../tools/statistics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <iomanip>
+#include <list>
 
 using Listen = naoqi_bridge_msgs::action::Listen;
 using ListenGoalHandle = rclcpp_action::ServerGoalHandle<Listen>;
@@ -41,24 +47,137 @@ namespace
     return iso_to_qichat.at(iso_language);
   }
 
+  // Number of compiled topics kept loaded in ALDialog
+  const size_t kMaxLoadedTopics = 8;
+
+  // Period at which cancellation requests are checked
+  const std::chrono::milliseconds kCancelCheckPeriod(50);
+
+  struct QueuedGoal {
+    std::shared_ptr<ListenGoalHandle> goal_handle;
+    std::string topic_name;
+    std::chrono::steady_clock::time_point queued_at;
+  };
+
   struct ListenState {
-    ListenState(rclcpp::Node* node, qi::SessionPtr session) :
+    ListenState(rclcpp::Node* node, qi::SessionPtr session, ListenPolicy policy, size_t queue_size) :
       node(node),
-      session(std::move(session))
+      session(std::move(session)),
+      policy(policy),
+      queue_size(std::min(queue_size, kMaxLoadedTopics - 1))
     {}
 
     rclcpp::Node* node;
     qi::SessionPtr session;
     rclcpp::Logger logger = node->get_logger();
     std::shared_ptr<ListenGoalHandle> current_goal;
+    std::string current_topic;
+    // Topic ALDialog is subscribed with, empty when not listening
+    std::string subscribed_topic;
     qi::AnyObject memory_subscriber;
+    rclcpp::TimerBase::SharedPtr cancel_timer;
+
+    // Loaded topics, most recently used first
+    std::list<std::string> loaded_topics;
+    tools::RunningStats start_latency;
+    size_t topic_cache_hits = 0;
+
+    // What to do with a goal received while listening
+    ListenPolicy policy;
+    size_t queue_size;
+    // Goals waiting for the current one, their topic is already loaded
+    std::deque<QueuedGoal> queue;
+    tools::RunningStats queue_wait;
+    tools::RunningStats switch_latency;
+    std::chrono::steady_clock::time_point last_stop;
+
+    // handlers run on the ROS executor, results arrive on qi threads
+    std::recursive_mutex mutex;
   };
 
-  std::string topic_name_for_goal_id(const rclcpp_action::GoalUUID& goal_id)
+  // Topics are named after their content, so that a topic loaded by a previous goal
+  // (or a previous run of the driver) can be activated again without compiling it
+  std::string topic_name_for_content(const std::string& language, std::vector<std::string> expected)
   {
-    std::string topic_name = rclcpp_action::to_string(goal_id);
-    boost::algorithm::replace_all(topic_name, "-", "");
-    return std::string("ros_") + topic_name;
+    std::sort(expected.begin(), expected.end());
+    // FNV-1a, stable across runs
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const std::string& text)
+    {
+      for (unsigned char c: text)
+      {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+      }
+      hash ^= 0xff;
+      hash *= 1099511628211ULL;
+    };
+    add(language);
+    for (const auto& utterance: expected)
+    {
+      add(utterance);
+    }
+    std::stringstream name_ss;
+    name_ss << "ros_" << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return name_ss.str();
+  }
+
+  // Load the topic if it is not loaded yet, and keep at most kMaxLoadedTopics loaded
+  bool load_topic(ListenState& state, qi::AnyObject& dialog, const std::string& topic_name,
+                  const std::string& language, const std::vector<std::string>& expected)
+  {
+    auto& logger = state.logger;
+    auto it = std::find(state.loaded_topics.begin(), state.loaded_topics.end(), topic_name);
+    if (it != state.loaded_topics.end())
+    {
+      state.loaded_topics.splice(state.loaded_topics.begin(), state.loaded_topics, it);
+      return true;
+    }
+
+    const auto already_loaded = dialog.call<std::vector<std::string> >("getAllLoadedTopics");
+    const bool cache_hit =
+      std::find(already_loaded.begin(), already_loaded.end(), topic_name) != already_loaded.end();
+    if (!cache_hit)
+    {
+      // Setup topic
+      std::stringstream pattern_ss;
+      pattern_ss << "[ ";
+      for (const auto& utterance: expected)
+      {
+        pattern_ss << "\"" << utterance << "\" ";
+      }
+      pattern_ss << "]";
+
+      std::stringstream topic_ss;
+      topic_ss << "topic: ~" << topic_name << " ()" << std::endl
+               << "language: " << language << std::endl
+               << "u:(_" << pattern_ss.str() << ") $" << topic_name << "/result=$1" << std::endl
+               << "u:(_*) $" << topic_name << "/result=$1" << std::endl;
+      std::string qichat_topic = topic_ss.str();
+      RCLCPP_INFO(logger, "Loading topic:\n%s", qichat_topic.c_str());
+      dialog.call<void>("loadTopicContent", qichat_topic);
+    }
+    state.loaded_topics.push_front(topic_name);
+
+    while (state.loaded_topics.size() > kMaxLoadedTopics)
+    {
+      const std::string evicted = state.loaded_topics.back();
+      state.loaded_topics.pop_back();
+      try
+      {
+        if (evicted == state.subscribed_topic)
+        {
+          dialog.call<void>("unsubscribe", evicted);
+          state.subscribed_topic.clear();
+        }
+        dialog.call<void>("unloadTopic", evicted);
+      }
+      catch (const std::exception& e)
+      {
+        RCLCPP_WARN(logger, "Failed to unload topic %s: %s", evicted.c_str(), e.what());
+      }
+    }
+    return cache_hit;
   }
 
   rclcpp_action::GoalResponse handle_goal(
@@ -69,13 +188,19 @@ namespace
     std::string goal_id = rclcpp_action::to_string(uuid);
     RCLCPP_INFO(state->logger, "Received goal request %s", goal_id.c_str());
 
+    std::lock_guard<std::recursive_mutex> lock(state->mutex);
     if (auto current_goal = state->current_goal) {
-      RCLCPP_INFO(
-        state->logger,
-        "Rejected request %s because the robot is already listening for request %s",
-        goal_id.c_str(),
-        rclcpp_action::to_string(current_goal->get_goal_id()).c_str());
-      return rclcpp_action::GoalResponse::REJECT;
+      const bool queue_full = state->queue.size() >= state->queue_size;
+      if (state->policy == ListenPolicy::Reject
+          || (state->policy == ListenPolicy::Queue && queue_full))
+      {
+        RCLCPP_INFO(
+          state->logger,
+          "Rejected request %s because the robot is already listening for request %s",
+          goal_id.c_str(),
+          rclcpp_action::to_string(current_goal->get_goal_id()).c_str());
+        return rclcpp_action::GoalResponse::REJECT;
+      }
     }
 
     RCLCPP_INFO(state->logger, "Accepted request %s", goal_id.c_str());
@@ -84,9 +209,47 @@ namespace
 
   void cleanup(ListenState &state);
 
-  void handle_accepted(
-    std::shared_ptr<ListenState> state,
-    const std::shared_ptr<ListenGoalHandle> goal_handle)
+  // Compile the topic of the goal, if it is not loaded yet
+  std::string prepare(ListenState& state, const std::shared_ptr<ListenGoalHandle>& goal_handle)
+  {
+    auto& logger = state.logger;
+    const auto& session = state.session;
+    auto dialog = session->service("ALDialog").value();
+
+    // Get language from goal or from dialog
+    const auto& iso_language = goal_handle->get_goal()->language;
+    const std::string language = [&]
+    {
+      if (iso_language.empty())
+      {
+        return dialog.call<std::string>("getLanguage");
+      }
+      else
+      {
+        return qichatLanguageFromIso(iso_language);
+      }
+    }();
+
+    const auto& expected = goal_handle->get_goal()->expected;
+    const auto topic_name = topic_name_for_content(language, expected);
+    bool was_loaded =
+      std::find(state.loaded_topics.begin(), state.loaded_topics.end(), topic_name) != state.loaded_topics.end();
+    was_loaded = load_topic(state, dialog, topic_name, language, expected) || was_loaded;
+    if (was_loaded)
+    {
+      ++state.topic_cache_hits;
+    }
+    RCLCPP_DEBUG(logger, "Topic %s %s", topic_name.c_str(), was_loaded ? "reused" : "compiled");
+    return topic_name;
+  }
+
+  void start_next(std::shared_ptr<ListenState> state);
+
+  // Listen for the goal with its topic, which must be loaded
+  void start(std::shared_ptr<ListenState> state,
+             const std::shared_ptr<ListenGoalHandle> goal_handle,
+             const std::string& topic_name,
+             const std::chrono::steady_clock::time_point& start_time)
   {
     auto& logger = state->logger;
     std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
@@ -94,8 +257,9 @@ namespace
     auto result = std::make_shared<Listen::Result>();
 
     const auto& session = state->session;
-    boost::algorithm::replace_all(goal_id, "-", "");
-    auto topic_name = std::string("ros_") + goal_id;
+    // set first, so that a failure below is cleaned up like the end of the goal
+    state->current_goal = goal_handle;
+    state->current_topic = topic_name;
 
     try
     {
@@ -110,39 +274,13 @@ namespace
         RCLCPP_INFO(logger, "Failed to enable free speech to text: %s", e.what());
       }
 
-      // Get language from goal or from dialog
-      const auto& iso_language = goal_handle->get_goal()->language;
-      const std::string language = [&]
-      {
-        if (iso_language.empty())
-        {
-          return dialog.call<std::string>("getLanguage");
-        }
-        else
-        {
-          return qichatLanguageFromIso(iso_language);
-        }
-      }();
-
-      // Setup topic
-      std::stringstream pattern_ss;
-      pattern_ss << "[ ";
-      for (const auto& utterance: goal_handle->get_goal()->expected)
+      dialog.call<void>("activateTopic", topic_name);
+      // unsubscribed when the goal ends
+      if (state->subscribed_topic != topic_name)
       {
-        pattern_ss << "\"" << utterance << "\" ";
+        dialog.call<void>("subscribe", topic_name);
+        state->subscribed_topic = topic_name;
       }
-      pattern_ss << "]";
-
-      std::stringstream topic_ss;
-      topic_ss << "topic: ~" << topic_name << " ()" << std::endl
-               << "language: " << language << std::endl
-               << "u:(_" << pattern_ss.str() << ") $" << topic_name << "/result=$1" << std::endl
-               << "u:(_*) $" << topic_name << "/result=$1" << std::endl;
-      std::string qichat_topic = topic_ss.str();
-      RCLCPP_INFO(logger, "Loading topic:\n%s", qichat_topic.c_str());
-      dialog.call<void>("loadTopicContent", qichat_topic);
-      dialog.call<void>("activateTopic", topic_name);
-      dialog.call<void>("subscribe", topic_name);
       dialog.call<void>("setFocus", topic_name);
 
       // auto memory_receiver = boost::make_shared<MemoryReceiver>();
@@ -152,14 +290,25 @@ namespace
       state->memory_subscriber = memory.call<qi::AnyObject>("subscriber", topic_name + "/result");
       state->memory_subscriber.connect("signal", [=](const qi::AnyValue& value)
       {
+        std::lock_guard<std::recursive_mutex> lock(state->mutex);
+        if (state->current_goal != goal_handle)
+        {
+          return;
+        }
         auto utterance = value.toString();
         RCLCPP_INFO(state->logger, "Received input: %s", utterance.c_str());
         result->result = std::vector<std::string>{utterance};
         cleanup(*state);
         goal_handle->succeed(result);
+        start_next(state);
       });
 
-      state->current_goal = goal_handle;
+      const double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+      state->start_latency.add(latency);
+      RCLCPP_INFO(logger, "Listen %s started in %.1f ms, mean %.1f ms, max %.1f ms, %zu/%zu topics reused",
+                  goal_id.c_str(), latency,
+                  state->start_latency.mean(), state->start_latency.max(),
+                  state->topic_cache_hits, state->start_latency.count());
     }
     catch (const std::exception& e)
     {
@@ -169,22 +318,109 @@ namespace
     }
   }
 
+  // Start the oldest queued goal, if any, right after the previous one stopped
+  void start_next(std::shared_ptr<ListenState> state)
+  {
+    while (!state->current_goal && !state->queue.empty())
+    {
+      QueuedGoal next = state->queue.front();
+      state->queue.pop_front();
+      if (!next.goal_handle->is_active())
+      {
+        continue;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      state->queue_wait.add(std::chrono::duration<double, std::milli>(now - next.queued_at).count());
+      start(state, next.goal_handle, next.topic_name, now);
+      state->switch_latency.add(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state->last_stop).count());
+      RCLCPP_INFO(state->logger, "Listen queue: wait mean %.1f ms, max %.1f ms, switch mean %.1f ms, max %.1f ms",
+                  state->queue_wait.mean(), state->queue_wait.max(),
+                  state->switch_latency.mean(), state->switch_latency.max());
+    }
+  }
+
+  void handle_accepted(
+    std::shared_ptr<ListenState> state,
+    const std::shared_ptr<ListenGoalHandle> goal_handle)
+  {
+    auto& logger = state->logger;
+    std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
+    const auto accepted_at = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::recursive_mutex> lock(state->mutex);
+    std::string topic_name;
+    try
+    {
+      topic_name = prepare(*state, goal_handle);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(logger, "Failed to load the topic of listen %s: %s", goal_id.c_str(), e.what());
+      goal_handle->abort(std::make_shared<Listen::Result>());
+      return;
+    }
+
+    if (auto current_goal = state->current_goal)
+    {
+      if (state->policy == ListenPolicy::Preempt)
+      {
+        RCLCPP_INFO(logger, "Listen %s preempted by %s",
+                    rclcpp_action::to_string(current_goal->get_goal_id()).c_str(), goal_id.c_str());
+        cleanup(*state);
+        current_goal->abort(std::make_shared<Listen::Result>());
+      }
+      else
+      {
+        // the topic is loaded now, so that the switch costs only its activation
+        RCLCPP_INFO(logger, "Listen %s queued", goal_id.c_str());
+        state->queue.push_back(QueuedGoal{goal_handle, topic_name, accepted_at});
+        return;
+      }
+    }
+
+    start(state, goal_handle, topic_name, accepted_at);
+  }
+
   rclcpp_action::CancelResponse handle_cancel(
     std::shared_ptr<ListenState> state,
     const std::shared_ptr<ListenGoalHandle> goal_handle)
   {
     std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
     RCLCPP_INFO(state->logger, "Received goal cancellation request %s", goal_id.c_str());
-    cleanup(*state);
-
-    // ROS2 action API requires that we set the canceled state after returning.
-    (void)std::async(
-      std::launch::async,
-      [state, goal_handle]{ goal_handle->canceled(std::make_shared<Listen::Result>()); }
-    );
+    // the cancel timer stops listening and sets the canceled state
     return rclcpp_action::CancelResponse::ACCEPT;
   }
 
+  // Set the canceled state of the goals being canceled, then start the next queued goal
+  void check_canceling(std::shared_ptr<ListenState> state)
+  {
+    std::lock_guard<std::recursive_mutex> lock(state->mutex);
+    for (auto it = state->queue.begin(); it != state->queue.end();)
+    {
+      if (it->goal_handle->is_canceling())
+      {
+        RCLCPP_INFO(state->logger, "Queued listen %s canceled",
+                    rclcpp_action::to_string(it->goal_handle->get_goal_id()).c_str());
+        it->goal_handle->canceled(std::make_shared<Listen::Result>());
+        it = state->queue.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    auto current_goal = state->current_goal;
+    if (current_goal && current_goal->is_canceling())
+    {
+      cleanup(*state);
+      current_goal->canceled(std::make_shared<Listen::Result>());
+      start_next(state);
+    }
+  }
+
   void cleanup(ListenState& state)
   {
     if (!state.current_goal) {
@@ -192,7 +428,7 @@ namespace
     }
 
     auto goal_id = rclcpp_action::to_string(state.current_goal->get_goal_id());
-    const auto topic_name = topic_name_for_goal_id(state.current_goal->get_goal_id());
+    const auto topic_name = state.current_topic;
 
     state.memory_subscriber.reset();
 
@@ -202,15 +438,6 @@ namespace
     {
       auto dialog = session->service("ALDialog").value();
 
-      // try
-      // {
-      //   dialog.call<void>("unsubscribe", topic_name);
-      // }
-      // catch (const std::exception& e)
-      // {
-      //   RCLCPP_WARN(logger, "Failed to unsubscribe from topic %s: %s", topic_name.c_str(), e.what());
-      // }
-
       try
       {
         dialog.call<void>("deactivateTopic", topic_name);
@@ -220,14 +447,22 @@ namespace
         RCLCPP_WARN(logger, "Failed to deactivate topic %s: %s", topic_name.c_str(), e.what());
       }
 
-      try
-      {
-        dialog.call<void>("unloadTopic", topic_name);
-      }
-      catch (const std::exception& e)
+      // paired with the subscription of the start of the goal
+      if (!state.subscribed_topic.empty())
       {
-        RCLCPP_WARN(logger, "Failed to unload topic %s: %s", topic_name.c_str(), e.what());
+        const std::string subscribed_topic = state.subscribed_topic;
+        state.subscribed_topic.clear();
+        try
+        {
+          dialog.call<void>("unsubscribe", subscribed_topic);
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_WARN(logger, "Failed to unsubscribe from topic %s: %s", subscribed_topic.c_str(), e.what());
+        }
       }
+
+      // the topic stays loaded for the next goals expecting the same utterances
     }
     catch (const std::exception& e)
     {
@@ -236,14 +471,24 @@ namespace
 
     RCLCPP_INFO(logger, "Listen %s stopped and cleaned up", goal_id.c_str());
     state.current_goal.reset();
+    state.current_topic.clear();
+    state.last_stop = std::chrono::steady_clock::now();
   }
 }
 
 rclcpp_action::Server<Listen>::SharedPtr
-createListenServer(rclcpp::Node* node, qi::SessionPtr session)
+createListenServer(rclcpp::Node* node, qi::SessionPtr session, ListenPolicy policy, size_t queue_size)
 {
   namespace ph = std::placeholders;
-  auto task = std::make_shared<ListenState>(node, std::move(session));
+  auto task = std::make_shared<ListenState>(node, std::move(session), policy, queue_size);
+  std::weak_ptr<ListenState> weak_task = task;
+  task->cancel_timer = node->create_wall_timer(kCancelCheckPeriod, [weak_task]
+  {
+    if (auto state = weak_task.lock())
+    {
+      check_canceling(state);
+    }
+  });
   return rclcpp_action::create_server<Listen>(
     node, "listen",
     std::bind(handle_goal, task, ph::_1, ph::_2),
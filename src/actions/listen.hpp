@@ -6,8 +6,17 @@ namespace naoqi
 {
 namespace action {
 
+// What to do with a goal received while the robot is listening
+enum class ListenPolicy
+{
+  Reject,  // reject it
+  Queue,   // run it after the current one, its topic is loaded meanwhile
+  Preempt  // abort the current goal and run it
+};
+
 rclcpp_action::Server<naoqi_bridge_msgs::action::Listen>::SharedPtr
-createListenServer(rclcpp::Node* node, qi::SessionPtr sesssion);
+createListenServer(rclcpp::Node* node, qi::SessionPtr sesssion,
+                   ListenPolicy policy = ListenPolicy::Reject, size_t queue_size = 4);
 
 } // ends namespace action
 } // ends namespace naoqi
\ No newline at end of file
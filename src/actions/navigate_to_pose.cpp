@@ -0,0 +1,220 @@
+#include "navigate_to_pose.hpp"
+#include "../tools/transform_cache.hpp"
+#include "../helpers/driver_helpers.hpp"
+#include "../helpers/transform_helpers.hpp"
+#include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+using NavigateToPose = nav2_msgs::action::NavigateToPose;
+using NavigateToPoseGoalHandle = rclcpp_action::ServerGoalHandle<NavigateToPose>;
+
+namespace naoqi
+{
+namespace action
+{
+namespace
+{
+  // Rate at which the progress is reported
+  const double kFeedbackRate = 5.0;
+  // Time given to the joint states converter to provide the transforms
+  const double kTransformTimeout = 2.0;
+
+  struct NavigateToPoseState {
+    NavigateToPoseState(rclcpp::Node* node, qi::SessionPtr session,
+                        boost::shared_ptr<tools::TransformCache> transform_cache) :
+      node(node),
+      session(std::move(session)),
+      transform_cache(std::move(transform_cache))
+    {}
+
+    rclcpp::Node* node;
+    qi::SessionPtr session;
+    boost::shared_ptr<tools::TransformCache> transform_cache;
+    rclcpp::Logger logger = node->get_logger();
+    std::mutex mutex;
+    std::shared_ptr<NavigateToPoseGoalHandle> current_goal;
+  };
+
+  // Pose expressed in the target frame, with the latest transforms of the cache
+  bool transformPose(
+    const tools::TransformCache& transform_cache,
+    const geometry_msgs::msg::PoseStamped& pose,
+    const std::string& target,
+    geometry_msgs::msg::PoseStamped& result)
+  {
+    if (pose.header.frame_id == target)
+    {
+      result = pose;
+      return true;
+    }
+    geometry_msgs::msg::TransformStamped transform;
+    if (!transform_cache.waitForTransform(target, pose.header.frame_id, kTransformTimeout)
+        || !transform_cache.lookupLatest(target, pose.header.frame_id, transform))
+    {
+      return false;
+    }
+    tf2::doTransform(pose, result, transform);
+    return true;
+  }
+
+  rclcpp_action::GoalResponse handle_goal(
+    std::shared_ptr<NavigateToPoseState> state,
+    const rclcpp_action::GoalUUID & uuid,
+    const std::shared_ptr<const NavigateToPose::Goal> goal)
+  {
+    std::string goal_id = rclcpp_action::to_string(uuid);
+    RCLCPP_INFO(state->logger, "Received navigation request %s", goal_id.c_str());
+
+    const std::string& frame_id = goal->pose.header.frame_id;
+    if (frame_id != "odom" && frame_id != "base_footprint")
+    {
+      RCLCPP_INFO(state->logger, "Rejected navigation %s: frame %s is neither odom nor base_footprint",
+                  goal_id.c_str(), frame_id.c_str());
+      return rclcpp_action::GoalResponse::REJECT;
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (auto current_goal = state->current_goal) {
+      RCLCPP_INFO(
+        state->logger,
+        "Rejected navigation %s because the robot is already navigating for request %s",
+        goal_id.c_str(),
+        rclcpp_action::to_string(current_goal->get_goal_id()).c_str());
+      return rclcpp_action::GoalResponse::REJECT;
+    }
+
+    RCLCPP_INFO(state->logger, "Accepted navigation %s", goal_id.c_str());
+    return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+  }
+
+  void finish(NavigateToPoseState& state)
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.current_goal.reset();
+    state.transform_cache->releaseInterest("base_footprint", "odom");
+    state.transform_cache->releaseInterest("odom", "base_footprint");
+  }
+
+  void execute(
+    std::shared_ptr<NavigateToPoseState> state,
+    const std::shared_ptr<NavigateToPoseGoalHandle> goal_handle)
+  {
+    auto& logger = state->logger;
+    std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
+    const auto& goal_pose = goal_handle->get_goal()->pose;
+    auto result = std::make_shared<NavigateToPose::Result>();
+
+    try
+    {
+      geometry_msgs::msg::PoseStamped goal_bf, goal_odom;
+      if (!transformPose(*state->transform_cache, goal_pose, "base_footprint", goal_bf)
+          || !transformPose(*state->transform_cache, goal_pose, "odom", goal_odom))
+      {
+        RCLCPP_ERROR(logger, "Navigation %s: cannot transform the goal from %s",
+                     goal_id.c_str(), goal_pose.header.frame_id.c_str());
+        finish(*state);
+        goal_handle->abort(result);
+        return;
+      }
+
+      double yaw = helpers::transform::getYaw(goal_bf.pose);
+      if (std::isnan(yaw)) {
+        yaw = 0.0;
+      }
+
+      auto motion = helpers::driver::getService(state->session, "ALMotion");
+      RCLCPP_INFO(logger, "Navigation %s starts: x %f y %f yaw %f", goal_id.c_str(),
+                  goal_bf.pose.position.x, goal_bf.pose.position.y, yaw);
+      const rclcpp::Time start = state->node->now();
+      qi::Future<void> moving = motion.async<void>(
+        "moveTo", goal_bf.pose.position.x, goal_bf.pose.position.y, yaw);
+
+      auto feedback = std::make_shared<NavigateToPose::Feedback>();
+      const int period_ms = static_cast<int>(1000.0 / kFeedbackRate);
+      while (moving.wait(period_ms) == qi::FutureState_Running)
+      {
+        if (goal_handle->is_canceling())
+        {
+          motion.call<void>("stopMove");
+          moving.wait();
+          RCLCPP_INFO(logger, "Navigation %s canceled", goal_id.c_str());
+          finish(*state);
+          goal_handle->canceled(result);
+          return;
+        }
+
+        geometry_msgs::msg::TransformStamped tf_base_in_odom;
+        if (state->transform_cache->lookupLatest("odom", "base_footprint", tf_base_in_odom))
+        {
+          feedback->current_pose.header = tf_base_in_odom.header;
+          feedback->current_pose.pose.position.x = tf_base_in_odom.transform.translation.x;
+          feedback->current_pose.pose.position.y = tf_base_in_odom.transform.translation.y;
+          feedback->current_pose.pose.position.z = tf_base_in_odom.transform.translation.z;
+          feedback->current_pose.pose.orientation = tf_base_in_odom.transform.rotation;
+          feedback->distance_remaining = std::hypot(
+            goal_odom.pose.position.x - tf_base_in_odom.transform.translation.x,
+            goal_odom.pose.position.y - tf_base_in_odom.transform.translation.y);
+        }
+        feedback->navigation_time = state->node->now() - start;
+        goal_handle->publish_feedback(feedback);
+      }
+
+      // also raises if the move failed
+      moving.value();
+      RCLCPP_INFO(logger, "Navigation %s done", goal_id.c_str());
+      finish(*state);
+      goal_handle->succeed(result);
+    }
+    catch (const std::exception& e)
+    {
+      RCLCPP_ERROR(logger, "Navigation %s failed: %s", goal_id.c_str(), e.what());
+      finish(*state);
+      goal_handle->abort(result);
+    }
+  }
+
+  void handle_accepted(
+    std::shared_ptr<NavigateToPoseState> state,
+    const std::shared_ptr<NavigateToPoseGoalHandle> goal_handle)
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->current_goal = goal_handle;
+      // the joint states ticks index the transforms only while a goal needs them
+      state->transform_cache->registerInterest("base_footprint", "odom");
+      state->transform_cache->registerInterest("odom", "base_footprint");
+    }
+    // the executor must not wait for the transforms nor the motion
+    std::thread(execute, state, goal_handle).detach();
+  }
+
+  rclcpp_action::CancelResponse handle_cancel(
+    std::shared_ptr<NavigateToPoseState> state,
+    const std::shared_ptr<NavigateToPoseGoalHandle> goal_handle)
+  {
+    std::string goal_id = rclcpp_action::to_string(goal_handle->get_goal_id());
+    RCLCPP_INFO(state->logger, "Received navigation cancellation request %s", goal_id.c_str());
+    // the execution thread stops the robot and sets the canceled state
+    return rclcpp_action::CancelResponse::ACCEPT;
+  }
+}
+
+rclcpp_action::Server<NavigateToPose>::SharedPtr
+createNavigateToPoseServer(rclcpp::Node* node, qi::SessionPtr session,
+                           const boost::shared_ptr<tools::TransformCache>& transform_cache)
+{
+  namespace ph = std::placeholders;
+  auto task = std::make_shared<NavigateToPoseState>(node, std::move(session), transform_cache);
+  return rclcpp_action::create_server<NavigateToPose>(
+    node, "navigate_to_pose",
+    std::bind(handle_goal, task, ph::_1, ph::_2),
+    std::bind(handle_cancel, task, ph::_1),
+    std::bind(handle_accepted, task, ph::_1)
+  );
+}
+
+} // ends namespace action
+} // ends namespace naoqi
@@ -0,0 +1,20 @@
+#include <rclcpp_action/rclcpp_action.hpp>
+#include <qi/session.hpp>
+#include <nav2_msgs/action/navigate_to_pose.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace naoqi
+{
+namespace tools
+{
+  class TransformCache;
+}
+
+namespace action {
+
+rclcpp_action::Server<nav2_msgs::action::NavigateToPose>::SharedPtr
+createNavigateToPoseServer(rclcpp::Node* node, qi::SessionPtr session,
+                           const boost::shared_ptr<tools::TransformCache>& transform_cache);
+
+} // ends namespace action
+} // ends namespace naoqi
@@ -57,7 +57,7 @@ public:
 
 private:
   /** Registered Callbacks **/
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
   naoqi_bridge_msgs::msg::AudioBuffer msg_;
 };
 
@@ -180,7 +180,7 @@ CameraConverter::CameraConverter(
   const int& camera_source,
   const int& resolution,
   const bool& has_stereo) : BaseConverter( name, frequency, session ),
-    p_video_( session->service("ALVideoDevice").value()),
+    p_video_( helpers::driver::getService( session, "ALVideoDevice" )),
     camera_source_(camera_source),
     resolution_(resolution),
     // change in case of depth camera
@@ -233,9 +233,14 @@ CameraConverter::~CameraConverter()
 
 void CameraConverter::reset()
 {
+  p_video_ = helpers::driver::getService( session_, "ALVideoDevice" );
   if (!handle_.empty())
   {
-    p_video_.call<qi::AnyValue>("unsubscribe", handle_);
+    try {
+      p_video_.call<qi::AnyValue>("unsubscribe", handle_);
+    } catch (const std::exception& e) {
+      // NAOqi restarted, the handle is already gone
+    }
     handle_.clear();
   }
 
@@ -254,6 +259,17 @@ void CameraConverter::registerCallback( const message_actions::MessageAction act
   callbacks_[action] = cb;
 }
 
+void CameraConverter::setResolution( int resolution )
+{
+  resolution_ = resolution;
+  camera_info_ = camera_info_definitions::getCameraInfo(camera_source_, resolution_);
+}
+
+void CameraConverter::setClockSync( const boost::shared_ptr<tools::ClockSync>& clock_sync )
+{
+  clock_sync_ = clock_sync;
+}
+
 void CameraConverter::callAll( const std::vector<message_actions::MessageAction>& actions )
 {
 
@@ -281,8 +297,12 @@ void CameraConverter::callAll( const std::vector<message_actions::MessageAction>
   msg_->header.frame_id = msg_frameid_;
 
   msg_->header.stamp = helpers::Time::now();
-  //msg_->header.stamp.sec = image.timestamp_s;
-  //msg_->header.stamp.nsec = image.timestamp_us*1000;
+  if ( clock_sync_ )
+  {
+    // use the capture time given by ALVideoDevice, mapped to the host clock
+    const int64_t capture_ns = static_cast<int64_t>(image.timestamp_s) * 1000000000 + static_cast<int64_t>(image.timestamp_us) * 1000;
+    msg_->header.stamp = clock_sync_->fromRemoteTime( name_, capture_ns, msg_->header.stamp );
+  }
   camera_info_.header.stamp = msg_->header.stamp;
 
   for( const message_actions::MessageAction& action: actions )
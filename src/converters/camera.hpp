@@ -22,6 +22,7 @@
 * LOCAL includes
 */
 #include "converter_base.hpp"
+#include "../tools/clock_sync.hpp"
 #include <naoqi_driver/message_actions.h>
 #include <naoqi_driver/ros_helpers.hpp>
 
@@ -38,7 +39,7 @@ namespace converter
 class CameraConverter : public BaseConverter<CameraConverter>
 {
 
-  typedef boost::function<void(sensor_msgs::msg::Image::SharedPtr, sensor_msgs::msg::CameraInfo)> Callback_t;
+  typedef boost::function<void(const sensor_msgs::msg::Image::SharedPtr&, const sensor_msgs::msg::CameraInfo&)> Callback_t;
 
 public:
   CameraConverter(
@@ -57,8 +58,15 @@ public:
 
   void callAll( const std::vector<message_actions::MessageAction>& actions );
 
+  void setClockSync( const boost::shared_ptr<tools::ClockSync>& clock_sync );
+
+  /**
+   * @brief change the resolution, applied on the next reset
+   */
+  void setResolution( int resolution );
+
 private:
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 
   /** VideoDevice (Proxy) configurations */
   qi::AnyObject p_video_;
@@ -75,6 +83,7 @@ private:
   std::string msg_frameid_;
   sensor_msgs::msg::CameraInfo camera_info_;
   sensor_msgs::msg::Image::SharedPtr msg_;
+  boost::shared_ptr<tools::ClockSync> clock_sync_;
 };
 
 } //publisher
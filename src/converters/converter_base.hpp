@@ -21,6 +21,7 @@
 /*
 * LOCAL includes
 */
+#include <naoqi_driver/message_actions.h>
 #include <naoqi_driver/tools.hpp>
 #include "../helpers/driver_helpers.hpp"
 
@@ -35,6 +36,31 @@ namespace naoqi
 namespace converter
 {
 
+/**
+ * @brief callbacks of a converter, indexed by action in a fixed array
+ * instead of looked up in a map on each tick
+ * @note only the lookup changes: the callbacks are still boost::function
+ * bound to the type-erased publishers and recorders, and the gain has not
+ * been measured
+ */
+template<class Callback>
+class CallbackTable
+{
+public:
+  inline Callback& operator[]( message_actions::MessageAction action )
+  {
+    return callbacks_[action];
+  }
+
+  inline void erase( message_actions::MessageAction action )
+  {
+    callbacks_[action].clear();
+  }
+
+private:
+  Callback callbacks_[message_actions::MESSAGE_ACTION_COUNT];
+};
+
 // CRTP
 template<class T>
 class BaseConverter
@@ -62,17 +88,23 @@ public:
     return frequency_;
   }
 
+  inline void setFrequency( float frequency )
+  {
+    frequency_ = frequency;
+  }
+
 protected:
   std::string name_;
 
   /** Frequency at which the converter should turn. This is informative */
   float frequency_;
   /** The type of the robot */
-  const robot::Robot& robot_;
+  const robot::Robot robot_;
   /* The version of the Naoqi Software on the robot */
-  const robot::NaoqiVersion& naoqi_version_;
+  const robot::NaoqiVersion naoqi_version_;
 
-  /** Pointer to a session from which we can create proxies */
+  /** Pointer to a session from which we can create proxies,
+   * they are resolved again on reset, once the session reconnected */
   qi::SessionPtr session_;
 
   /** Enable recording */
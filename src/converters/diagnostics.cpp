@@ -48,13 +48,13 @@ namespace converter
 
 DiagnosticsConverter::DiagnosticsConverter( const std::string& name, float frequency, const qi::SessionPtr& session ):
     BaseConverter( name, frequency, session ),
-    p_memory_(session->service("ALMemory").value()),
+    p_memory_(helpers::driver::getService( session, "ALMemory" )),
     temperature_warn_level_(68),
     temperature_error_level_(74)
 {
   // Allow for temperature reporting (for CPU)
   if ((robot_ == robot::PEPPER) || (robot_ == robot::NAO)) {
-    p_body_temperature_ = session->service("ALBodyTemperature").value();
+    p_body_temperature_ = helpers::driver::getService( session, "ALBodyTemperature" );
 
     // Only call setEnableNotifications if NAOqi < 2.9
     if (helpers::driver::isNaoqiVersionLesser(naoqi_version_, 2, 8))
@@ -67,20 +67,25 @@ DiagnosticsConverter::DiagnosticsConverter( const std::string& name, float frequ
   qi::AnyValue qi_joint_limits;
 
   // Get all the joint names
-  this->p_motion_ = session->service("ALMotion").value();
+  this->p_motion_ = helpers::driver::getService( session, "ALMotion" );
   joint_names_ = this->p_motion_.call<std::vector<std::string> >("getBodyNames", "JointActuators");
 
+  // Request all the joint limits at once, instead of one round-trip per joint
+  std::vector<qi::Future<qi::AnyValue> > getting_joint_limits;
   for(std::vector<std::string>::const_iterator it = joint_names_.begin(); it != joint_names_.end(); ++it) {
-    all_keys_.push_back(std::string("Device/SubDeviceList/") + (*it) + std::string("/Temperature/Sensor/Value"));
-    all_keys_.push_back(std::string("Device/SubDeviceList/") + (*it) + std::string("/Hardness/Actuator/Value"));
+    getting_joint_limits.push_back(this->p_motion_.async<qi::AnyValue>("getLimits", (*it)));
+  }
+
+  for(size_t i = 0; i < joint_names_.size(); ++i) {
+    const std::string& joint_name = joint_names_[i];
+    all_keys_.push_back(std::string("Device/SubDeviceList/") + joint_name + std::string("/Temperature/Sensor/Value"));
+    all_keys_.push_back(std::string("Device/SubDeviceList/") + joint_name + std::string("/Hardness/Actuator/Value"));
 
     // Get the joint limits
     joint_limits.clear();
 
     try {
-         qi_joint_limits = this->p_motion_.call<qi::AnyValue>(
-                    "getLimits",
-                    (*it));
+         qi_joint_limits = getting_joint_limits[i].value();
 
     } catch (const std::exception &e) {
         std::cerr << "Exception caught in DiagnosticsConverter: "
@@ -100,13 +105,13 @@ DiagnosticsConverter::DiagnosticsConverter( const std::string& name, float frequ
         continue;
     }
 
-    this->joint_limit_map_[(*it)].push_back(
+    this->joint_limit_map_[joint_name].push_back(
                 static_cast<double>(joint_limits[0][0]));
-    this->joint_limit_map_[(*it)].push_back(
+    this->joint_limit_map_[joint_name].push_back(
                 static_cast<double>(joint_limits[0][1]));
-    this->joint_limit_map_[(*it)].push_back(
+    this->joint_limit_map_[joint_name].push_back(
                 static_cast<double>(joint_limits[0][2]));
-    this->joint_limit_map_[(*it)].push_back(
+    this->joint_limit_map_[joint_name].push_back(
                 static_cast<double>(joint_limits[0][3]));
   }
 
@@ -310,6 +315,11 @@ void DiagnosticsConverter::callAll( const std::vector<message_actions::MessageAc
 
 void DiagnosticsConverter::reset()
 {
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+  p_motion_ = helpers::driver::getService( session_, "ALMotion" );
+  if ((robot_ == robot::PEPPER) || (robot_ == robot::NAO)) {
+    p_body_temperature_ = helpers::driver::getService( session_, "ALBodyTemperature" );
+  }
 }
 
 void DiagnosticsConverter::registerCallback( const message_actions::MessageAction action, Callback_t cb )
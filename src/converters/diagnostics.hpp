@@ -74,7 +74,7 @@ private:
   float temperature_error_level_;
 
   /** Registered Callbacks **/
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 };
 
 } //converter
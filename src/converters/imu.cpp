@@ -35,34 +35,17 @@ namespace converter {
 
   ImuConverter::ImuConverter(const std::string& name, const IMU::Location& location,  const float& frequency, const qi::SessionPtr& session):
     BaseConverter(name, frequency, session),
-    p_memory_(session->service("ALMemory").value())
+    p_memory_(helpers::driver::getService( session, "ALMemory" ))
   {
     if(location == IMU::TORSO){
       msg_imu_.header.frame_id = "base_link";
-      data_names_list_.push_back("DCM/Time");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/AngleX/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/AngleY/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/AngleZ/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/GyroscopeX/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/GyroscopeY/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/GyroscopeZ/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/AccelerometerX/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/AccelerometerY/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensor/AccelerometerZ/Sensor/Value");
     }
     else if(location == IMU::BASE){
       msg_imu_.header.frame_id = "base_footprint";
-      data_names_list_.push_back("DCM/Time");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/AngleX/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/AngleY/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/AngleZ/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/GyroscopeX/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/GyroscopeY/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/GyroscopeZ/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/AccelerometerX/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/AccelerometerY/Sensor/Value");
-      data_names_list_.push_back("Device/SubDeviceList/InertialSensorBase/AccelerometerZ/Sensor/Value");
     }
+    data_names_list_.push_back("DCM/Time");
+    const std::vector<std::string>& keys = getMemoryKeys(location);
+    data_names_list_.insert(data_names_list_.end(), keys.begin(), keys.end());
   }
 
   ImuConverter::~ImuConverter()
@@ -72,7 +55,7 @@ namespace converter {
 
   void ImuConverter::reset()
   {
-
+    p_memory_ = helpers::driver::getService( session_, "ALMemory" );
   }
 
   void ImuConverter::registerCallback( const message_actions::MessageAction action, Callback_t cb )
@@ -80,46 +63,71 @@ namespace converter {
     callbacks_[action] = cb;
   }
 
+  void ImuConverter::setClockSync(const boost::shared_ptr<tools::ClockSync>& clock_sync)
+  {
+    clock_sync_ = clock_sync;
+  }
+
+  std::vector<std::string> ImuConverter::getMemoryKeys(const IMU::Location& location)
+  {
+    const std::string device = (location == IMU::BASE) ? "InertialSensorBase" : "InertialSensor";
+    static const char* values[] = {
+      "AngleX", "AngleY", "AngleZ",
+      "GyroscopeX", "GyroscopeY", "GyroscopeZ",
+      "AccelerometerX", "AccelerometerY", "AccelerometerZ"
+    };
+
+    std::vector<std::string> keys;
+    for (size_t i=0; i<sizeof(values)/sizeof(values[0]); ++i)
+    {
+      keys.push_back("Device/SubDeviceList/" + device + "/" + values[i] + "/Sensor/Value");
+    }
+    return keys;
+  }
+
+  void ImuConverter::fillMessage(sensor_msgs::msg::Imu& msg, const std::vector<float>& mem_data, size_t offset)
+  {
+    // angle (X,Y,Z) = mem_data(offset+0,1,2);
+    // gyro  (X,Y,Z) = mem_data(offset+3,4,5);
+    // acc   (X,Y,Z) = mem_data(offset+6,7,8);
+    tf2::Quaternion tf_quat;
+    tf_quat.setRPY( mem_data[offset], mem_data[offset+1], mem_data[offset+2] );
+    msg.orientation = tf2::toMsg( tf_quat );
+
+    msg.angular_velocity.x = mem_data[offset+3];
+    msg.angular_velocity.y = mem_data[offset+4];
+    msg.angular_velocity.z = mem_data[offset+5];
+
+    msg.linear_acceleration.x = mem_data[offset+6];
+    msg.linear_acceleration.y = mem_data[offset+7];
+    msg.linear_acceleration.z = mem_data[offset+8];
+
+    // Covariances unknown
+    msg.orientation_covariance[0] = -1;
+    msg.angular_velocity_covariance[0] = -1;
+    msg.linear_acceleration_covariance[0] = -1;
+  }
+
   void ImuConverter::callAll(const std::vector<message_actions::MessageAction>& actions)
   {
     // Get inertial data
     std::vector<float> memData;
+    int64_t dcm_time_ms = 0;
     try {
         qi::AnyValue anyvalues = p_memory_.call<qi::AnyValue>("getListData", data_names_list_);
+        // DCM/Time does not fit in a float
+        dcm_time_ms = anyvalues.asListValuePtr()[0].content().toInt();
         tools::fromAnyValueToFloatVector(anyvalues, memData);
     } catch (const std::exception& e) {
       std::cerr << "Exception caught in ImuConverter: " << e.what() << std::endl;
       return;
     }
-    // angle (X,Y,Z) = memData(1,2,3);
-    // gyro  (X,Y,Z) = memData(4,5,6);
-    // acc   (X,Y,Z) = memData(7,8,9);
-
-    const rclcpp::Time& stamp = helpers::Time::now();
+    // stamp with the time the DCM sampled the values when the robot clock is known
+    const rclcpp::Time& stamp = clock_sync_ ? clock_sync_->fromDcmTime(dcm_time_ms) : helpers::Time::now();
     msg_imu_.header.stamp = stamp;
 
-    tf2::Quaternion tf_quat;
-    tf_quat.setRPY( memData[1], memData[2], memData[3] );
-    msg_imu_.orientation = tf2::toMsg( tf_quat );
-
-    //msg_imu_.orientation = tf::createQuaternionMsgFromRollPitchYaw(
-    //                            memData[1],
-    //                            memData[2],
-    //                            memData[3]);
-
-    msg_imu_.angular_velocity.x = memData[4];
-    msg_imu_.angular_velocity.y = memData[5];
-    msg_imu_.angular_velocity.z = memData[6];
-
-    msg_imu_.linear_acceleration.x = memData[7];
-    msg_imu_.linear_acceleration.y = memData[8];
-    msg_imu_.linear_acceleration.z = memData[9];
-
-    // Covariances unknown
-    msg_imu_.orientation_covariance[0] = -1;
-    msg_imu_.angular_velocity_covariance[0] = -1;
-    msg_imu_.linear_acceleration_covariance[0] = -1;
-
+    // memData[0] is DCM/Time
+    fillMessage(msg_imu_, memData, 1);
 
     for( message_actions::MessageAction action: actions )
     {
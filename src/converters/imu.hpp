@@ -22,6 +22,7 @@
 * LOCAL includes
 */
 #include "converter_base.hpp"
+#include "../tools/clock_sync.hpp"
 #include <naoqi_driver/message_actions.h>
 #include <naoqi_driver/ros_helpers.hpp>
 
@@ -59,13 +60,27 @@ public:
 
   virtual void callAll(const std::vector<message_actions::MessageAction>& actions);
 
+  void setClockSync(const boost::shared_ptr<tools::ClockSync>& clock_sync);
+
+  /**
+   * @brief memory keys of the inertial unit at the given location,
+   * in the order expected by fillMessage (angle, gyroscope, accelerometer)
+   */
+  static std::vector<std::string> getMemoryKeys(const IMU::Location& location);
+
+  /**
+   * @brief fill an Imu message from the values read in memory, starting at offset
+   */
+  static void fillMessage(sensor_msgs::msg::Imu& msg, const std::vector<float>& mem_data, size_t offset);
+
 private:
   sensor_msgs::msg::Imu msg_imu_;
   qi::AnyObject p_memory_;
   std::vector<std::string> data_names_list_;
+  boost::shared_ptr<tools::ClockSync> clock_sync_;
 
   /** Registered Callbacks **/
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 };
 
 }
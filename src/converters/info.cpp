@@ -33,7 +33,7 @@ namespace converter
 
 InfoConverter::InfoConverter( const std::string& name, float frequency, const qi::SessionPtr& session )
   : BaseConverter( name, frequency, session ),
-    p_memory_( session->service("ALMemory").value() )
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) )
 {
   keys_.push_back("RobotConfig/Head/FullHeadId");
   keys_.push_back("Device/DeviceList/ChestBoard/BodyId");
@@ -57,6 +57,7 @@ InfoConverter::InfoConverter( const std::string& name, float frequency, const qi
 
 void InfoConverter::reset()
 {
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
 }
 
 void InfoConverter::registerCallback( const message_actions::MessageAction action, Callback_t cb )
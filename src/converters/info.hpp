@@ -56,7 +56,7 @@ private:
 
   /** The keys to get from ALMemory */
   std::vector<std::string> keys_;
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 
   naoqi_bridge_msgs::msg::StringStamped msg_;
 };
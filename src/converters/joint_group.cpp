@@ -0,0 +1,129 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "joint_group.hpp"
+#include "../tools/from_any_value.hpp"
+
+/*
+* STANDARD includes
+*/
+#include <algorithm>
+#include <limits>
+
+namespace naoqi
+{
+namespace converter
+{
+
+JointGroupConverter::JointGroupConverter( const std::string& name, const float& frequency, const std::vector<std::string>& body_names, const qi::SessionPtr& session ):
+  BaseConverter( name, frequency, session ),
+  body_names_( body_names ),
+  p_motion_( helpers::driver::getService( session, "ALMotion" ) ),
+  p_memory_( helpers::driver::getService( session, "ALMemory" ) )
+{
+}
+
+void JointGroupConverter::reset()
+{
+  p_motion_ = helpers::driver::getService( session_, "ALMotion" );
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+
+  msg_joint_states_.name.clear();
+  data_names_list_.clear();
+  velocity_index_.clear();
+  effort_index_.clear();
+
+  for ( std::vector<std::string>::const_iterator it = body_names_.begin(); it != body_names_.end(); ++it )
+  {
+    std::vector<std::string> names;
+    try {
+      names = p_motion_.call<std::vector<std::string> >( "getBodyNames", *it );
+    } catch (const std::exception& e) {
+      std::cerr << "Joint group " << name_ << ": unknown chain or joint " << *it << std::endl;
+      continue;
+    }
+    for ( std::vector<std::string>::const_iterator itName = names.begin(); itName != names.end(); ++itName )
+    {
+      if ( std::find( msg_joint_states_.name.begin(), msg_joint_states_.name.end(), *itName ) == msg_joint_states_.name.end() )
+        msg_joint_states_.name.push_back( *itName );
+    }
+  }
+
+  for ( std::vector<std::string>::const_iterator itName = msg_joint_states_.name.begin();
+        itName != msg_joint_states_.name.end();
+        ++itName )
+  {
+    const std::string velocity_key = "Motion/Velocity/Sensor/" + (*itName);
+    velocity_index_.push_back( helpers::driver::hasMemoryKey( session_, velocity_key ) ? data_names_list_.size() : -1 );
+    if ( velocity_index_.back() >= 0 )
+      data_names_list_.push_back( velocity_key );
+
+    const std::string effort_key = "Motion/Torque/Sensor/" + (*itName);
+    effort_index_.push_back( helpers::driver::hasMemoryKey( session_, effort_key ) ? data_names_list_.size() : -1 );
+    if ( effort_index_.back() >= 0 )
+      data_names_list_.push_back( effort_key );
+  }
+}
+
+void JointGroupConverter::registerCallback( const message_actions::MessageAction action, Callback_t cb )
+{
+  callbacks_[action] = cb;
+}
+
+void JointGroupConverter::callAll( const std::vector<message_actions::MessageAction>& actions )
+{
+  if ( msg_joint_states_.name.empty() )
+    return;
+
+  // the angles are read while memory is read
+  qi::Future<std::vector<double> > getting_angles = p_motion_.async<std::vector<double> >( "getAngles", msg_joint_states_.name, true );
+
+  std::vector<float> mem_data;
+  try {
+    if ( !data_names_list_.empty() )
+    {
+      qi::AnyValue anyvalues = p_memory_.call<qi::AnyValue>( "getListData", data_names_list_ );
+      tools::fromAnyValueToFloatVector( anyvalues, mem_data );
+    }
+    msg_joint_states_.position = getting_angles.value();
+  } catch (const std::exception& e) {
+    std::cerr << "Exception caught in JointGroupConverter: " << e.what() << std::endl;
+    return;
+  }
+
+  msg_joint_states_.header.stamp = helpers::Time::now();
+  msg_joint_states_.velocity.assign( msg_joint_states_.name.size(), std::numeric_limits<double>::quiet_NaN() );
+  msg_joint_states_.effort.assign( msg_joint_states_.name.size(), std::numeric_limits<double>::quiet_NaN() );
+  for ( size_t i=0; i<msg_joint_states_.name.size(); ++i )
+  {
+    if ( velocity_index_[i] >= 0 )
+      msg_joint_states_.velocity[i] = mem_data[velocity_index_[i]];
+    if ( effort_index_[i] >= 0 )
+      msg_joint_states_.effort[i] = mem_data[effort_index_[i]];
+  }
+
+  for( message_actions::MessageAction action: actions )
+  {
+    callbacks_[action]( msg_joint_states_ );
+  }
+}
+
+} //converter
+} // naoqi
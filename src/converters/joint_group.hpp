@@ -0,0 +1,84 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef JOINT_GROUP_CONVERTER_HPP
+#define JOINT_GROUP_CONVERTER_HPP
+
+/*
+* LOCAL includes
+*/
+#include "converter_base.hpp"
+#include <naoqi_driver/message_actions.h>
+#include <naoqi_driver/ros_helpers.hpp>
+
+/*
+* ROS includes
+*/
+#include <sensor_msgs/msg/joint_state.hpp>
+
+namespace naoqi
+{
+namespace converter
+{
+
+/**
+ * @brief Joint states of a subset of the body (chains or single joints),
+ * so that each group can be read at its own rate without fetching the whole body.
+ * Transforms are left to the joint states converter.
+ */
+class JointGroupConverter : public BaseConverter<JointGroupConverter>
+{
+
+  typedef boost::function<void(sensor_msgs::msg::JointState&) > Callback_t;
+
+public:
+  /**
+   * @param body_names chain or joint names, as accepted by ALMotion getBodyNames
+   */
+  JointGroupConverter( const std::string& name, const float& frequency, const std::vector<std::string>& body_names, const qi::SessionPtr& session );
+
+  void reset( );
+
+  void registerCallback( const message_actions::MessageAction action, Callback_t cb );
+
+  void callAll( const std::vector<message_actions::MessageAction>& actions );
+
+private:
+  std::vector<std::string> body_names_;
+
+  /** Motion Proxy **/
+  qi::AnyObject p_motion_;
+  qi::AnyObject p_memory_;
+
+  /** velocity and torque keys read with getListData */
+  std::vector<std::string> data_names_list_;
+  /** index in data_names_list_ of each joint sensor, -1 if not available */
+  std::vector<int> velocity_index_;
+  std::vector<int> effort_index_;
+
+  /** JointState Message **/
+  sensor_msgs::msg::JointState msg_joint_states_;
+
+  /** Registered Callbacks **/
+  CallbackTable<Callback_t> callbacks_;
+
+}; // class
+
+} //converter
+} // naoqi
+
+#endif
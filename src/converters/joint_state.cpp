@@ -21,11 +21,14 @@
 #include "joint_state.hpp"
 #include "nao_footprint.hpp"
 
+/*
+* BOOST includes
+*/
+#include <boost/chrono.hpp>
+
 /*
 * ROS includes
 */
-#include <urdf/model.h>
-#include <kdl_parser/kdl_parser.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
 namespace naoqi
@@ -34,11 +37,12 @@ namespace naoqi
 namespace converter
 {
 
-JointStateConverter::JointStateConverter( const std::string& name, const float& frequency, const BufferPtr& tf2_buffer, const qi::SessionPtr& session ):
+JointStateConverter::JointStateConverter( const std::string& name, const float& frequency, const TransformCachePtr& transform_cache, const qi::SessionPtr& session ):
   BaseConverter( name, frequency, session ),
-  p_motion_( session->service("ALMotion").value() ),
-  p_memory_( session->service("ALMemory").value() ),
-  tf2_buffer_(tf2_buffer)
+  p_motion_( helpers::driver::getService( session, "ALMotion" ) ),
+  p_memory_( helpers::driver::getService( session, "ALMemory" ) ),
+  transform_cache_(transform_cache),
+  publish_odom_transform_(true)
 {
 }
 
@@ -49,6 +53,9 @@ JointStateConverter::~JointStateConverter()
 
 void JointStateConverter::reset()
 {
+  p_motion_ = helpers::driver::getService( session_, "ALMotion" );
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+
   std::string robot_desc = naoqi::tools::getRobotDescription(robot_);
   if ( robot_desc.empty() )
   {
@@ -56,22 +63,55 @@ void JointStateConverter::reset()
     return;
   }
 
-  urdf::Model model;
-  model.initString(robot_desc);
-  KDL::Tree tree;
-  kdl_parser::treeFromUrdfModel( model, tree );
+  // the URDF is only parsed the first time, or when it changed
+  kinematic_model_ = tools::KinematicModel::fromDescription( robot_desc );
+  if ( !kinematic_model_ )
+  {
+    std::cout << "error in compiling robot description" << std::endl;
+    return;
+  }
+
+  // pre-fill joint states message
+  msg_joint_states_.name = p_motion_.call<std::vector<std::string> >("getBodyNames", "Body" );
+  bindKinematicModel();
+}
 
-  addChildren( tree.getRootSegment() );
+void JointStateConverter::bindKinematicModel()
+{
+  std::map<std::string, int> name_index;
+  for ( size_t i=0; i<msg_joint_states_.name.size(); ++i )
+  {
+    name_index[msg_joint_states_.name[i]] = i;
+  }
 
-  // set mimic joint list
-  mimic_.clear();
-  for(std::map< std::string, urdf::JointSharedPtr >::iterator i = model.joints_.begin(); i != model.joints_.end(); i++){
-    if(i->second->mimic){
-      mimic_.insert(make_pair(i->first, i->second->mimic));
+  const std::vector<tools::KinematicModel::Segment>& moving = kinematic_model_->moving();
+  joint_position_index_.assign( moving.size(), -1 );
+  for ( size_t i=0; i<moving.size(); ++i )
+  {
+    // a mimic joint follows its master when the master is published
+    std::map<std::string, int>::const_iterator found = name_index.end();
+    if ( moving[i].mimic >= 0 )
+    {
+      found = name_index.find( moving[moving[i].mimic].joint );
+    }
+    if ( found == name_index.end() )
+    {
+      found = name_index.find( moving[i].joint );
+    }
+    if ( found != name_index.end() )
+    {
+      joint_position_index_[i] = found->second;
     }
   }
-  // pre-fill joint states message
-  msg_joint_states_.name = p_motion_.call<std::vector<std::string> >("getBodyNames", "Body" );
+
+  const std::vector<tools::KinematicModel::Segment>& fixed = kinematic_model_->fixed();
+  fixed_transforms_.resize( fixed.size() );
+  for ( size_t i=0; i<fixed.size(); ++i )
+  {
+    fixed_transforms_[i].header.frame_id = fixed[i].parent;
+    fixed_transforms_[i].child_frame_id = fixed[i].child;
+    tools::KinematicModel::computeTransform( fixed[i], 0.0, fixed_transforms_[i].transform );
+  }
 }
 
 void JointStateConverter::registerCallback( const message_actions::MessageAction action, Callback_t cb )
@@ -79,6 +119,16 @@ void JointStateConverter::registerCallback( const message_actions::MessageAction
   callbacks_[action] = cb;
 }
 
+void JointStateConverter::setPoseCache( const boost::shared_ptr<tools::PoseCache>& pose_cache )
+{
+  pose_cache_ = pose_cache;
+}
+
+void JointStateConverter::setPublishOdomTransform( bool state )
+{
+  publish_odom_transform_ = state;
+}
+
 void JointStateConverter::callAll( const std::vector<message_actions::MessageAction>& actions )
 {
   /*
@@ -87,40 +137,20 @@ void JointStateConverter::callAll( const std::vector<message_actions::MessageAct
    * but this would require a proper URDF
    * with a base_link and base_footprint in the base
    */
-  auto getting_odometry_data = p_motion_.async<std::vector<float> >( "getPosition", "Torso", 1, true );
+  rclcpp::Time odom_requested;
+  qi::Future<std::vector<float> > getting_odometry_data = pose_cache_
+    ? pose_cache_->getTorsoPose( odom_requested )
+    : p_motion_.async<std::vector<float> >( "getPosition", "Torso", 1, true );
 
   // get joint state values
   std::vector<double> al_joint_angles = p_motion_.call<std::vector<double> >("getAngles", "Body", true );
   std::vector<double> al_joint_velocities;
   std::vector<double> al_joint_torques;
 
-  std::vector<float> al_odometry_data = getting_odometry_data.value();
-  const rclcpp::Time& stamp = helpers::Time::now();
-
-  /**
-   * JOINT STATE PUBLISHER
-   */
-  msg_joint_states_.header.stamp = stamp;
-
-  // STUPID CONVERTION FROM FLOAT TO DOUBLE ARRAY --> OPTIMIZE THAT!
-  msg_joint_states_.position = std::vector<double>( al_joint_angles.begin(), al_joint_angles.end() );
-
-  /**
-   * ROBOT STATE PUBLISHER
-   */
-  // put joint states in tf broadcaster
-  std::map< std::string, double > joint_state_map;
-  // stupid version --> change this with std::transform c++11 ??!
-//  std::transform( msg_joint_states_.name.begin(), msg_joint_states_.name.end(), msg_joint_states_.position.begin(),
-//                  std::inserter( joint_state_map, joint_state_map.end() ),
-//                  std::make_pair);
-  std::vector<double>::const_iterator itPos = msg_joint_states_.position.begin();
   for(std::vector<std::string>::const_iterator itName = msg_joint_states_.name.begin();
       itName != msg_joint_states_.name.end();
-      ++itName, ++itPos)
+      ++itName)
   {
-    joint_state_map[*itName] = *itPos;
-
     try {
       al_joint_velocities.push_back(p_memory_.call<double>(
         "getData",
@@ -137,27 +167,73 @@ void JointStateConverter::callAll( const std::vector<message_actions::MessageAct
     }
   }
 
-  msg_joint_states_.velocity = al_joint_velocities;
-  msg_joint_states_.effort = al_joint_torques;
+  std::vector<float> al_odometry_data = getting_odometry_data.value();
+  const rclcpp::Time& stamp = helpers::Time::now();
 
-  // for mimic map
-  for(MimicMap::iterator i = mimic_.begin(); i != mimic_.end(); i++){
-    if(joint_state_map.find(i->second->joint_name) != joint_state_map.end()){
-      double pos = joint_state_map[i->second->joint_name] * i->second->multiplier + i->second->offset;
-      joint_state_map[i->first] = pos;
-    }
+  // a pose reused from the cache was sampled when it was requested
+  updateState( stamp, al_joint_angles, al_joint_velocities, al_joint_torques, al_odometry_data,
+               pose_cache_ ? odom_requested : stamp );
+
+  for( message_actions::MessageAction action: actions )
+  {
+    callbacks_[action]( msg_joint_states_, tf_transforms_ );
   }
+}
 
+void JointStateConverter::updateState( const rclcpp::Time& stamp,
+                                       const std::vector<double>& positions,
+                                       const std::vector<double>& velocities,
+                                       const std::vector<double>& efforts,
+                                       const std::vector<float>& al_odometry_data,
+                                       const rclcpp::Time& odom_stamp )
+{
+  const boost::chrono::steady_clock::time_point update_start = boost::chrono::steady_clock::now();
+
+  /**
+   * JOINT STATE PUBLISHER
+   */
+  msg_joint_states_.header.stamp = stamp;
+  msg_joint_states_.position = positions;
+  msg_joint_states_.velocity = velocities;
+  msg_joint_states_.effort = efforts;
+
+  /**
+   * ROBOT STATE PUBLISHER
+   */
   // reset the transforms we want to use at this time
   tf_transforms_.clear();
-  static const std::string& jt_tf_prefix = "";
-  setTransforms(joint_state_map, stamp, jt_tf_prefix);
-  setFixedTransforms(jt_tf_prefix, stamp);
+  if ( kinematic_model_ )
+  {
+    const std::vector<tools::KinematicModel::Segment>& moving = kinematic_model_->moving();
+    geometry_msgs::msg::TransformStamped tf_transform;
+    tf_transform.header.stamp = stamp;
+    for ( size_t i=0; i<moving.size(); ++i )
+    {
+      const int index = joint_position_index_[i];
+      if ( index < 0 || index >= static_cast<int>( positions.size() ) )
+        continue;
+
+      double position = positions[index];
+      if ( moving[i].mimic >= 0 && msg_joint_states_.name[index] != moving[i].joint )
+      {
+        position = position * moving[i].multiplier + moving[i].offset;
+      }
+      tf_transform.header.frame_id = moving[i].parent; // tf2 does not suppport tf_prefixing
+      tf_transform.child_frame_id = moving[i].child;
+      tools::KinematicModel::computeTransform( moving[i], position, tf_transform.transform );
+      tf_transforms_.push_back( tf_transform );
+    }
+
+    for ( std::vector<geometry_msgs::msg::TransformStamped>::iterator it = fixed_transforms_.begin(); it != fixed_transforms_.end(); ++it )
+    {
+      it->header.stamp = stamp;
+      tf_transforms_.push_back( *it );
+    }
+  }
 
   /**
    * ODOMETRY
    */
-  const rclcpp::Time &odom_stamp = stamp;
   const float &odomX = al_odometry_data[0];
   const float& odomY  =  al_odometry_data[1];
   const float& odomZ  =  al_odometry_data[2];
@@ -179,105 +255,52 @@ void JointStateConverter::callAll( const std::vector<message_actions::MessageAct
   msg_tf_odom.transform.translation.z = odomZ;
   msg_tf_odom.transform.rotation = odom_quat;
 
-  tf_transforms_.push_back( msg_tf_odom );
-  tf2_buffer_->setTransform( msg_tf_odom, "naoqiconverter", false);
-
-  if (robot_ == robot::NAO )
+  if ( publish_odom_transform_ )
   {
-    nao::addBaseFootprint( tf2_buffer_, tf_transforms_, odom_stamp - tf2::durationFromSec(0.1) );
+    tf_transforms_.push_back( msg_tf_odom );
   }
 
-  // If nobody uses that buffer, do not fill it next time
-  if (( tf2_buffer_ ) && ( tf2_buffer_.use_count() == 1 ))
+  // the transforms of this tick are only indexed if the footprint or an internal consumer needs them
+  const bool has_interest = transform_cache_ && transform_cache_->hasInterest();
+  const boost::chrono::steady_clock::time_point cache_start = boost::chrono::steady_clock::now();
+  if ( robot_ == robot::NAO || has_interest )
   {
-    tf2_buffer_.reset();
+    tf_table_.clear();
+    for ( std::vector<geometry_msgs::msg::TransformStamped>::const_iterator it = tf_transforms_.begin(); it != tf_transforms_.end(); ++it )
+    {
+      tf_table_.add( *it );
+    }
+    if ( !publish_odom_transform_ )
+    {
+      tf_table_.add( msg_tf_odom );
+    }
   }
 
-  for( message_actions::MessageAction action: actions )
+  if (robot_ == robot::NAO )
   {
-    callbacks_[action]( msg_joint_states_, tf_transforms_ );
+    // the footprint only depends on this tick, compose it from the table
+    nao::addBaseFootprint( tf_table_, tf_transforms_, stamp );
   }
-}
-
 
-// Copied from robot state publisher
-void JointStateConverter::setTransforms(const std::map<std::string, double>& joint_positions, const rclcpp::Time& time, const std::string& tf_prefix)
-{
-  geometry_msgs::msg::TransformStamped tf_transform;
-  tf_transform.header.stamp = time;
-
-  // loop over all joints
-  for (std::map<std::string, double>::const_iterator jnt=joint_positions.begin(); jnt != joint_positions.end(); jnt++){
-    std::map<std::string, robot_state_publisher::SegmentPair>::const_iterator seg = segments_.find(jnt->first);
-    if (seg != segments_.end()){
-      seg->second.segment.pose(jnt->second).M.GetQuaternion(tf_transform.transform.rotation.x,
-                                                            tf_transform.transform.rotation.y,
-                                                            tf_transform.transform.rotation.z,
-                                                            tf_transform.transform.rotation.w);
-      tf_transform.transform.translation.x = seg->second.segment.pose(jnt->second).p.x();
-      tf_transform.transform.translation.y = seg->second.segment.pose(jnt->second).p.y();
-      tf_transform.transform.translation.z = seg->second.segment.pose(jnt->second).p.z();
-
-      //tf_transform.header.frame_id = tf::resolve(tf_prefix, seg->second.root);
-      //tf_transform.child_frame_id = tf::resolve(tf_prefix, seg->second.tip);
-      tf_transform.header.frame_id = seg->second.root; // tf2 does not suppport tf_prefixing
-      tf_transform.child_frame_id = seg->second.tip;
-
-      tf_transforms_.push_back(tf_transform);
-
-      if (tf2_buffer_)
-          tf2_buffer_->setTransform(tf_transform, "naoqiconverter", false);
-    }
+  if ( has_interest )
+  {
+    transform_cache_->update( tf_table_, stamp );
   }
-  //tf_broadcaster_.sendTransform(tf_transforms);
-}
 
-// Copied from robot state publisher
-void JointStateConverter::setFixedTransforms(const std::string& tf_prefix, const rclcpp::Time& time)
-{
-  geometry_msgs::msg::TransformStamped tf_transform;
-  tf_transform.header.stamp = time;
-
-  // loop over all fixed segments
-  for (std::map<std::string, robot_state_publisher::SegmentPair>::const_iterator seg=segments_fixed_.begin(); seg != segments_fixed_.end(); seg++){
-    seg->second.segment.pose(0).M.GetQuaternion(tf_transform.transform.rotation.x,
-                                                tf_transform.transform.rotation.y,
-                                                tf_transform.transform.rotation.z,
-                                                tf_transform.transform.rotation.w);
-    tf_transform.transform.translation.x = seg->second.segment.pose(0).p.x();
-    tf_transform.transform.translation.y = seg->second.segment.pose(0).p.y();
-    tf_transform.transform.translation.z = seg->second.segment.pose(0).p.z();
-
-    //tf_transform.header.frame_id = tf::resolve(tf_prefix, seg->second.root);
-    //tf_transform.child_frame_id = tf::resolve(tf_prefix, seg->second.tip);
-    tf_transform.header.frame_id = seg->second.root;
-    tf_transform.child_frame_id = seg->second.tip;
-
-    tf_transforms_.push_back(tf_transform);
-
-    if (tf2_buffer_)
-      tf2_buffer_->setTransform(tf_transform, "naoqiconverter", true);
+  const boost::chrono::steady_clock::time_point update_end = boost::chrono::steady_clock::now();
+  update_time_.add( boost::chrono::duration<double, boost::milli>( update_end - update_start ).count() );
+  if ( has_interest )
+  {
+    cache_time_.add( boost::chrono::duration<double, boost::milli>( update_end - cache_start ).count() );
   }
-  //tf_broadcaster_.sendTransform(tf_transforms);
-}
-
-void JointStateConverter::addChildren(const KDL::SegmentMap::const_iterator segment)
-{
-  const std::string& root = GetTreeElementSegment(segment->second).getName();
-
-  const std::vector<KDL::SegmentMap::const_iterator>& children = GetTreeElementChildren(segment->second);
-  for (unsigned int i=0; i<children.size(); i++){
-    const KDL::Segment& child = GetTreeElementSegment(children[i]->second);
-    robot_state_publisher::SegmentPair s(GetTreeElementSegment(children[i]->second), root, child.getName());
-    if (child.getJoint().getType() == KDL::Joint::None){
-      segments_fixed_.insert(std::make_pair(child.getJoint().getName(), s));
-      RCLCPP_DEBUG(helpers::Node::get_logger(), "Adding fixed segment from %s to %s", root.c_str(), child.getName().c_str());
-    }
-    else{
-      segments_.insert(std::make_pair(child.getJoint().getName(), s));
-      RCLCPP_DEBUG(helpers::Node::get_logger(), "Adding moving segment from %s to %s", root.c_str(), child.getName().c_str());
-    }
-    addChildren(children[i]);
+  if ( report_.due() )
+  {
+    // the cost without the cache is the update time minus the cache time
+    RCLCPP_DEBUG( helpers::Node::get_logger(), "%s state update over %zu ticks: mean %.3f ms, max %.3f ms; transform cache fed on %zu ticks: mean %.3f ms, max %.3f ms",
+                  name_.c_str(), update_time_.count(), update_time_.mean(), update_time_.max(),
+                  cache_time_.count(), cache_time_.mean(), cache_time_.max() );
+    update_time_.reset();
+    cache_time_.reset();
   }
 }
 
@@ -23,16 +23,18 @@
 */
 #include "converter_base.hpp"
 #include "../tools/robot_description.hpp"
+#include "../tools/kinematic_model.hpp"
+#include "../tools/pose_cache.hpp"
+#include "../tools/statistics.hpp"
+#include "../tools/transform_cache.hpp"
+#include "../helpers/transform_helpers.hpp"
 #include <naoqi_driver/message_actions.h>
 #include <naoqi_driver/ros_helpers.hpp>
 
 /*
 * ROS includes
 */
-#include <urdf/model.h>
 #include <sensor_msgs/msg/joint_state.hpp>
-#include <tf2_ros/buffer.h>
-#include <robot_state_publisher/robot_state_publisher.hpp>
 
 namespace naoqi
 {
@@ -44,12 +46,10 @@ class JointStateConverter : public BaseConverter<JointStateConverter>
 
   typedef boost::function<void(sensor_msgs::msg::JointState&, std::vector<geometry_msgs::msg::TransformStamped>&) > Callback_t;
 
-  typedef boost::shared_ptr<tf2_ros::Buffer> BufferPtr;
-
-  typedef std::map<std::string, urdf::JointMimicSharedPtr> MimicMap;
+  typedef boost::shared_ptr<tools::TransformCache> TransformCachePtr;
 
 public:
-  JointStateConverter( const std::string& name, const float& frequency, const BufferPtr& tf2_buffer, const qi::SessionPtr& session );
+  JointStateConverter( const std::string& name, const float& frequency, const TransformCachePtr& transform_cache, const qi::SessionPtr& session );
 
   ~JointStateConverter();
 
@@ -59,26 +59,56 @@ public:
 
   void callAll( const std::vector<message_actions::MessageAction>& actions );
 
-private:
+  void setPoseCache( const boost::shared_ptr<tools::PoseCache>& pose_cache );
+
+  /**
+   * @brief choose whether odom->base_link is part of the published transforms,
+   * it is still given to the transform cache
+   */
+  void setPublishOdomTransform( bool state );
+
+protected:
+  /**
+   * @brief fill the joint states message and the transforms from data
+   * fetched on the robot, all stamped with the given time
+   * @param al_odometry_data torso position in the world frame (x, y, z, wx, wy, wz)
+   * @param odom_stamp time the torso position was sampled at, for the odom transform
+   */
+  void updateState( const rclcpp::Time& stamp,
+                    const std::vector<double>& positions,
+                    const std::vector<double>& velocities,
+                    const std::vector<double>& efforts,
+                    const std::vector<float>& al_odometry_data,
+                    const rclcpp::Time& odom_stamp );
+
+
+  /**
+   * @brief match the moving joints of the kinematic model with the joint
+   * names of the message, and prepare the fixed transforms
+   */
+  void bindKinematicModel();
+
+  /** Kinematic model of the robot description, shared by all the converters **/
+  boost::shared_ptr<const tools::KinematicModel> kinematic_model_;
 
-  /** blatently copied from robot state publisher */
-  void addChildren(const KDL::SegmentMap::const_iterator segment);
-  std::map<std::string, robot_state_publisher::SegmentPair> segments_, segments_fixed_;
-  void setTransforms(const std::map<std::string, double>& joint_positions, const rclcpp::Time& time, const std::string& tf_prefix);
-  void setFixedTransforms(const std::string& tf_prefix, const rclcpp::Time& time);
+  /** for each moving joint of the model, index in the joint states of its position (or of the mimicked joint), -1 if absent **/
+  std::vector<int> joint_position_index_;
 
-  /** Global Shared tf2 buffer **/
-  BufferPtr tf2_buffer_;
+  /** fixed transforms, only the stamp changes from one tick to another **/
+  std::vector<geometry_msgs::msg::TransformStamped> fixed_transforms_;
+
+  /** Transforms needed inside the driver, only filled if someone registered interest **/
+  TransformCachePtr transform_cache_;
 
   /** Motion Proxy **/
   qi::AnyObject p_motion_;
   qi::AnyObject p_memory_;
 
-  /** Registered Callbacks **/
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  /** Torso pose shared with the other converters, may be null **/
+  boost::shared_ptr<tools::PoseCache> pose_cache_;
 
-  /** MimicJoint List **/
-  MimicMap mimic_;
+  /** false when odom->base_link is published by the odometry converter **/
+  bool publish_odom_transform_;
 
   /** JointState Message **/
   sensor_msgs::msg::JointState msg_joint_states_;
@@ -86,6 +116,18 @@ private:
   /** Transform Messages **/
   std::vector<geometry_msgs::msg::TransformStamped> tf_transforms_;
 
+  /** Transforms of the current tick, indexed by child frame **/
+  helpers::transform::TransformTable tf_table_;
+
+  /** Time spent computing the state of a tick, and the part of it spent feeding the transform cache, in ms **/
+  tools::RunningStats update_time_;
+  tools::RunningStats cache_time_;
+  tools::StatsReport report_;
+
+private:
+  /** Registered Callbacks **/
+  CallbackTable<Callback_t> callbacks_;
+
 }; // class
 
 } //publisher
@@ -124,7 +124,7 @@ static const char* laserMemoryKeys[] = {
 
 LaserConverter::LaserConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session ):
   BaseConverter( name, frequency, session ),
-  p_memory_(session->service("ALMemory").value())
+  p_memory_(helpers::driver::getService( session, "ALMemory" ))
 {
 }
 
@@ -206,6 +206,8 @@ void LaserConverter::callAll( const std::vector<message_actions::MessageAction>&
 
 void LaserConverter::reset( )
 {
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+
   msg_.header.frame_id = "base_footprint";
   msg_.angle_min = -2.0944;   // -120
   msg_.angle_max = 2.0944;    // +120
@@ -57,7 +57,7 @@ private:
   float range_min_;
   float range_max_;
 
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
   sensor_msgs::msg::LaserScan msg_;
 }; // class
 
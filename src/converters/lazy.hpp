@@ -0,0 +1,147 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef LAZY_CONVERTER_HPP
+#define LAZY_CONVERTER_HPP
+
+/*
+* STANDARD includes
+*/
+#include <iostream>
+#include <string>
+
+/*
+* BOOST includes
+*/
+#include <boost/chrono.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+/*
+* LOCAL includes
+*/
+#include <naoqi_driver/converter/converter.hpp>
+
+namespace naoqi
+{
+namespace converter
+{
+
+/**
+ * @brief Converter standing in for another one until its data is needed.
+ * The wrapped converter (and what it subscribes to on the robot) is built
+ * on the first call with an action, and destroyed once no action was
+ * requested for the idle timeout. Publishers and recorders are registered
+ * as usual, so the topics are advertised from the start.
+ */
+class LazyConverter
+{
+public:
+  typedef boost::function<Converter()> Factory;
+
+  LazyConverter( const std::string& name, float frequency, const Factory& factory, float idle_timeout ):
+    name_( name ),
+    frequency_( frequency ),
+    factory_( factory ),
+    idle_timeout_( idle_timeout )
+  {}
+
+  inline std::string name() const
+  {
+    return name_;
+  }
+
+  inline float frequency() const
+  {
+    return frequency_;
+  }
+
+  /**
+   * @brief change the frequency, forwarded to the wrapped converter if it is built
+   */
+  void setFrequency( float frequency )
+  {
+    frequency_ = frequency;
+    if ( converter_ )
+    {
+      converter_->setFrequency( frequency );
+    }
+  }
+
+  inline bool isBuilt() const
+  {
+    return bool( converter_ );
+  }
+
+  /**
+   * @brief reset the wrapped converter if it is built, it is reset when built otherwise
+   */
+  void reset()
+  {
+    if ( converter_ )
+    {
+      converter_->reset();
+    }
+  }
+
+  void callAll( const std::vector<message_actions::MessageAction>& actions )
+  {
+    last_call_ = boost::chrono::steady_clock::now();
+    if ( !converter_ )
+    {
+      try {
+        converter_.reset( new Converter( factory_() ) );
+        converter_->setFrequency( frequency_ );
+        converter_->reset();
+      } catch (const std::exception& e) {
+        std::cerr << "Could not build converter " << name_ << ": " << e.what() << std::endl;
+        converter_.reset();
+        return;
+      }
+      std::cout << "Converter " << name_ << " built on its first consumer, in "
+                << boost::chrono::duration<double, boost::milli>( boost::chrono::steady_clock::now() - last_call_ ).count()
+                << " ms" << std::endl;
+    }
+    converter_->callAll( actions );
+  }
+
+  /**
+   * @brief destroy the wrapped converter if no action was requested for the idle timeout
+   */
+  void releaseIfIdle()
+  {
+    if ( converter_ && boost::chrono::duration<double>( boost::chrono::steady_clock::now() - last_call_ ).count() > idle_timeout_ )
+    {
+      std::cout << "Converter " << name_ << " released after " << idle_timeout_ << " s without consumer" << std::endl;
+      converter_.reset();
+    }
+  }
+
+private:
+  std::string name_;
+  float frequency_;
+  Factory factory_;
+  float idle_timeout_;
+
+  boost::shared_ptr<Converter> converter_;
+  boost::chrono::steady_clock::time_point last_call_;
+};
+
+} // converter
+} // naoqi
+
+#endif
@@ -114,9 +114,10 @@ void logCallback(const qi::LogMessage& msg)
 
 LogConverter::LogConverter( const std::string& name, float frequency, const qi::SessionPtr& session )
   : BaseConverter( name, frequency, session ),
-    logger_( session->service("LogManager").value() ),
+    logger_( helpers::driver::getService( session, "LogManager" ) ),
     // Default log level is info
-    log_level_(qi::LogLevel_Info)
+    log_level_(qi::LogLevel_Info),
+    listener_link_(qi::SignalBase::invalidSignalLink)
 {
   // Define the log equivalents
   LogLevel(qi::LogLevel_Silent, rcl_interfaces::msg::Log::DEBUG, RCUTILS_LOG_SEVERITY_DEBUG);
@@ -127,13 +128,6 @@ LogConverter::LogConverter( const std::string& name, float frequency, const qi::
   LogLevel(qi::LogLevel_Verbose, rcl_interfaces::msg::Log::DEBUG, RCUTILS_LOG_SEVERITY_DEBUG);
   LogLevel(qi::LogLevel_Debug, rcl_interfaces::msg::Log::DEBUG, RCUTILS_LOG_SEVERITY_DEBUG);
 
-  // TEMPORARY CODE, WEIRD BUG
-  qi::AnyObject p_manager = session->service("LogManager").value();
-  auto test_obj = p_manager.call<qi::AnyObject>("getListener");
-  qi::LogListenerPtr test = static_cast<qi::LogListenerPtr>(test_obj);
-  test->onLogMessage.connect(logCallback);
-  // END
-
   // listener_ = logger_->getListener();
   set_qi_logger_level();
   // listener_->onLogMessage.connect(logCallback);
@@ -163,6 +157,25 @@ void LogConverter::callAll( const std::vector<message_actions::MessageAction>& a
 
 void LogConverter::reset( )
 {
+  // the listener is registered again on the new session after a reconnection
+  qi::AnyObject p_manager = helpers::driver::getService( session_, "LogManager" );
+  logger_ = qi::LogManagerPtr( p_manager );
+
+  // a reset without reconnection must not connect logCallback twice and duplicate the logs
+  if ( listener_ && listener_link_ != qi::SignalBase::invalidSignalLink )
+  {
+    try {
+      listener_->onLogMessage.disconnect( listener_link_ );
+    } catch (const std::exception& e) {
+      // the listener died with the previous session
+    }
+  }
+
+  // TEMPORARY CODE, WEIRD BUG
+  auto test_obj = p_manager.call<qi::AnyObject>("getListener");
+  listener_ = static_cast<qi::LogListenerPtr>(test_obj);
+  listener_link_ = listener_->onLogMessage.connect(logCallback);
+  // END
 }
 
 void LogConverter::set_qi_logger_level( )
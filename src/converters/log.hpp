@@ -55,8 +55,10 @@ private:
   /** Log level that is currently translated to ROS */
   qi::LogLevel log_level_;
   qi::LogListenerPtr listener_;
+  /** Connection of logCallback to the listener, removed on reset */
+  qi::SignalLink listener_link_;
 
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 };
 
 } //publisher
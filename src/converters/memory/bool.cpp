@@ -29,7 +29,7 @@ namespace converter
 MemoryBoolConverter::MemoryBoolConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session, const std::string& memory_key )
   : BaseConverter( name, frequency, session ),
     memory_key_(memory_key),
-    p_memory_( session->service("ALMemory").value() )
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) )
 {}
 
 void MemoryBoolConverter::registerCallback( message_actions::MessageAction action, Callback_t cb )
@@ -62,7 +62,9 @@ void MemoryBoolConverter::callAll( const std::vector<message_actions::MessageAct
 }
 
 void MemoryBoolConverter::reset( )
-{}
+{
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+}
 
 } // publisher
 } //naoqi
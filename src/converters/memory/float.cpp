@@ -28,7 +28,7 @@ namespace converter
 MemoryFloatConverter::MemoryFloatConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session, const std::string& memory_key )
   : BaseConverter( name, frequency, session ),
     memory_key_(memory_key),
-    p_memory_( session->service("ALMemory").value() )
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) )
 {}
 
 void MemoryFloatConverter::registerCallback( message_actions::MessageAction action, Callback_t cb )
@@ -65,7 +65,9 @@ void MemoryFloatConverter::callAll( const std::vector<message_actions::MessageAc
 }
 
 void MemoryFloatConverter::reset( )
-{}
+{
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+}
 
 } // publisher
 } //naoqi
@@ -29,7 +29,7 @@ namespace converter
 MemoryIntConverter::MemoryIntConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session, const std::string& memory_key )
   : BaseConverter( name, frequency, session ),
     memory_key_(memory_key),
-    p_memory_( session->service("ALMemory").value() )
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) )
 {}
 
 void MemoryIntConverter::registerCallback( message_actions::MessageAction action, Callback_t cb )
@@ -66,7 +66,9 @@ void MemoryIntConverter::callAll( const std::vector<message_actions::MessageActi
 }
 
 void MemoryIntConverter::reset( )
-{}
+{
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+}
 
 } // publisher
 } //naoqi
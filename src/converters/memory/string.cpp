@@ -29,7 +29,7 @@ namespace converter
 MemoryStringConverter::MemoryStringConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session, const std::string& memory_key )
   : BaseConverter( name, frequency, session ),
     memory_key_(memory_key),
-    p_memory_( session->service("ALMemory").value() )
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) )
 {}
 
 void MemoryStringConverter::registerCallback( message_actions::MessageAction action, Callback_t cb )
@@ -66,7 +66,9 @@ void MemoryStringConverter::callAll( const std::vector<message_actions::MessageA
 }
 
 void MemoryStringConverter::reset( )
-{}
+{
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+}
 
 } // publisher
 } //naoqi
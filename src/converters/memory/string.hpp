@@ -58,7 +58,7 @@ private:
   /** Memory (Proxy) configurations */
   qi::AnyObject p_memory_;
 
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
   naoqi_bridge_msgs::msg::StringStamped msg_;
 
 }; // class
@@ -27,12 +27,12 @@ namespace converter {
 
 MemoryListConverter::MemoryListConverter(const std::vector<std::string>& key_list, const std::string &name, const float &frequency, const qi::SessionPtr &session):
     BaseConverter(name, frequency, session),
-    p_memory_(session->service("ALMemory").value()),
+    p_memory_(helpers::driver::getService( session, "ALMemory" )),
     _key_list(key_list)
 {}
 
 void MemoryListConverter::reset(){
-
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
 }
 
 void MemoryListConverter::callAll(const std::vector<message_actions::MessageAction> &actions){
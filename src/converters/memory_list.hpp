@@ -54,7 +54,7 @@ private:
   std::vector<std::string> data_names_list_;
 
   /** Registered Callbacks **/
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 };
 
 }
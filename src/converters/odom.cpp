@@ -31,9 +31,17 @@ namespace converter
 
 OdomConverter::OdomConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session ):
   BaseConverter( name, frequency, session ),
-  p_motion_( session->service("ALMotion").value() )
-
+  p_motion_( helpers::driver::getService( session, "ALMotion" ) ),
+  sample_frequency_( 0 ),
+  correction_time_( 0.1 ),
+  has_sample_( false ),
+  is_fetching_( false ),
+  correction_x_( 0 ),
+  correction_y_( 0 ),
+  correction_yaw_( 0 )
 {
+  msg_.header.frame_id = "odom";
+  msg_.child_frame_id = "base_link";
 }
 
 void OdomConverter::registerCallback( message_actions::MessageAction action, Callback_t cb )
@@ -41,60 +49,179 @@ void OdomConverter::registerCallback( message_actions::MessageAction action, Cal
   callbacks_[action] = cb;
 }
 
-void OdomConverter::callAll( const std::vector<message_actions::MessageAction>& actions )
+void OdomConverter::setPrediction( float sample_frequency, float correction_time )
 {
+  // no prediction needed if NAOqi is polled at the publishing rate
+  sample_frequency_ = (sample_frequency < frequency_) ? sample_frequency : 0;
+  correction_time_ = correction_time;
+}
 
-  int FRAME_WORLD = 1;
-  bool use_sensor = true;
-  // documentation of getPosition available here: http://doc.aldebaran.com/2-1/naoqi/motion/control-cartesian.html
-  std::vector<float> al_odometry_data = p_motion_.call<std::vector<float> >( "getPosition", "Torso", FRAME_WORLD, use_sensor );
+void OdomConverter::fillSample( OdomSample& sample, const std::vector<float>& al_odometry_data,
+                                const std::vector<float>& al_speed_data, const rclcpp::Time& stamp )
+{
+  sample.x     = al_odometry_data[0];
+  sample.y     = al_odometry_data[1];
+  sample.z     = al_odometry_data[2];
+  sample.roll  = al_odometry_data[3];
+  sample.pitch = al_odometry_data[4];
+  sample.yaw   = al_odometry_data[5];
+
+  sample.vx = al_speed_data[0];
+  sample.vy = al_speed_data[1];
+  sample.wz = al_speed_data[2];
+
+  sample.stamp = stamp;
+}
 
-  const rclcpp::Time& odom_stamp = helpers::Time::now();
-  std::vector<float> al_speed_data = p_motion_.call<std::vector<float> >( "getRobotVelocity" );
+OdomConverter::OdomSample OdomConverter::predict( const rclcpp::Time& t ) const
+{
+  static const double max_extrapolation = 0.5;
+  OdomSample prediction = sample_;
+  prediction.stamp = t;
+
+  // constant twist in the robot frame, integrated around the mid heading
+  const double dt = std::min( std::max( t.seconds() - sample_.stamp.seconds(), 0.0 ), max_extrapolation );
+  const double mid_yaw = sample_.yaw + 0.5 * sample_.wz * dt;
+  prediction.x += ( std::cos(mid_yaw) * sample_.vx - std::sin(mid_yaw) * sample_.vy ) * dt;
+  prediction.y += ( std::sin(mid_yaw) * sample_.vx + std::cos(mid_yaw) * sample_.vy ) * dt;
+  prediction.yaw += sample_.wz * dt;
+
+  // absorb the error of the previous prediction smoothly instead of jumping
+  const double since_correction = std::max( t.seconds() - correction_stamp_.seconds(), 0.0 );
+  const double decay = (correction_time_ > 0) ? std::exp( -since_correction / correction_time_ ) : 0.0;
+  prediction.x += decay * correction_x_;
+  prediction.y += decay * correction_y_;
+  prediction.yaw += decay * correction_yaw_;
+
+  return prediction;
+}
 
-  const float& odomX  =  al_odometry_data[0];
-  const float& odomY  =  al_odometry_data[1];
-  const float& odomZ  =  al_odometry_data[2];
-  const float& odomWX =  al_odometry_data[3];
-  const float& odomWY =  al_odometry_data[4];
-  const float& odomWZ =  al_odometry_data[5];
+void OdomConverter::onSample( const OdomSample& sample )
+{
+  if ( has_sample_ )
+  {
+    const OdomSample prediction = predict( sample.stamp );
+    correction_x_ = prediction.x - sample.x;
+    correction_y_ = prediction.y - sample.y;
+    correction_yaw_ = std::atan2( std::sin(prediction.yaw - sample.yaw), std::cos(prediction.yaw - sample.yaw) );
+    correction_stamp_ = sample.stamp;
+
+    position_error_.add( std::sqrt( correction_x_*correction_x_ + correction_y_*correction_y_ ) );
+    yaw_error_.add( std::fabs( correction_yaw_ ) );
+  }
+  sample_ = sample;
+  has_sample_ = true;
 
-  const float& dX = al_speed_data[0];
-  const float& dY = al_speed_data[1];
-  const float& dWZ = al_speed_data[2];
+  if ( position_error_.count() > 0 && report_.due() )
+  {
+    RCLCPP_INFO( helpers::Node::get_logger(), "Odometry prediction error over %zu samples: position mean %.4f m, rms %.4f m, max %.4f m / yaw mean %.4f rad, max %.4f rad",
+                 position_error_.count(), position_error_.mean(), position_error_.rms(), position_error_.max(),
+                 yaw_error_.mean(), yaw_error_.max() );
+    position_error_.reset();
+    yaw_error_.reset();
+  }
+}
 
+void OdomConverter::fillMessage( const OdomSample& sample )
+{
   //since all odometry is 6DOF we'll need a quaternion created from yaw
   tf2::Quaternion tf_quat;
-  tf_quat.setRPY( odomWX, odomWY, odomWZ );
+  tf_quat.setRPY( sample.roll, sample.pitch, sample.yaw );
   geometry_msgs::msg::Quaternion odom_quat = tf2::toMsg( tf_quat );
 
-  static nav_msgs::msg::Odometry msg_odom;
-  msg_odom.header.frame_id = "odom";
-  msg_odom.child_frame_id = "base_link";
-  msg_odom.header.stamp = odom_stamp;
+  msg_.header.stamp = sample.stamp;
 
-  msg_odom.pose.pose.orientation = odom_quat;
-  msg_odom.pose.pose.position.x = odomX;
-  msg_odom.pose.pose.position.y = odomY;
-  msg_odom.pose.pose.position.z = odomZ;
+  msg_.pose.pose.orientation = odom_quat;
+  msg_.pose.pose.position.x = sample.x;
+  msg_.pose.pose.position.y = sample.y;
+  msg_.pose.pose.position.z = sample.z;
 
-  msg_odom.twist.twist.linear.x = dX;
-  msg_odom.twist.twist.linear.y = dY;
-  msg_odom.twist.twist.linear.z = 0;
+  msg_.twist.twist.linear.x = sample.vx;
+  msg_.twist.twist.linear.y = sample.vy;
+  msg_.twist.twist.linear.z = 0;
 
-  msg_odom.twist.twist.angular.x = 0;
-  msg_odom.twist.twist.angular.y = 0;
-  msg_odom.twist.twist.angular.z = dWZ;
+  msg_.twist.twist.angular.x = 0;
+  msg_.twist.twist.angular.y = 0;
+  msg_.twist.twist.angular.z = sample.wz;
+}
+
+void OdomConverter::callAll( const std::vector<message_actions::MessageAction>& actions )
+{
+
+  int FRAME_WORLD = 1;
+  bool use_sensor = true;
+
+  if ( sample_frequency_ <= 0 )
+  {
+    // documentation of getPosition available here: http://doc.aldebaran.com/2-1/naoqi/motion/control-cartesian.html
+    // both requests are issued before waiting for any of them
+    rclcpp::Time odom_requested;
+    qi::Future<std::vector<float> > getting_odometry_data = pose_cache_
+      ? pose_cache_->getTorsoPose( odom_requested )
+      : p_motion_.async<std::vector<float> >( "getPosition", "Torso", FRAME_WORLD, use_sensor );
+    qi::Future<std::vector<float> > getting_speed_data = p_motion_.async<std::vector<float> >( "getRobotVelocity" );
+
+    std::vector<float> al_odometry_data = getting_odometry_data.value();
+    // a pose reused from the cache was sampled when it was requested
+    const rclcpp::Time odom_stamp = pose_cache_ ? odom_requested : helpers::Time::now();
+    std::vector<float> al_speed_data = getting_speed_data.value();
+
+    fillSample( sample_, al_odometry_data, al_speed_data, odom_stamp );
+    fillMessage( sample_ );
+  }
+  else
+  {
+    const rclcpp::Time& now = helpers::Time::now();
+
+    // collect the last sample without waiting for it
+    if ( is_fetching_ && getting_odometry_data_.isFinished() && getting_speed_data_.isFinished() )
+    {
+      is_fetching_ = false;
+      if ( getting_odometry_data_.hasValue() && getting_speed_data_.hasValue() )
+      {
+        // sampled somewhere between the request and now
+        const rclcpp::Time stamp( fetch_stamp_.nanoseconds() + (now.nanoseconds() - fetch_stamp_.nanoseconds()) / 2, now.get_clock_type() );
+        OdomSample sample;
+        fillSample( sample, getting_odometry_data_.value(), getting_speed_data_.value(), stamp );
+        onSample( sample );
+      }
+    }
+
+    if ( !is_fetching_ && ( !has_sample_ || now.seconds() - fetch_stamp_.seconds() >= 1.0 / sample_frequency_ ) )
+    {
+      // not through the pose cache: a pose sampled earlier than the twist would bias the prediction error
+      getting_odometry_data_ = p_motion_.async<std::vector<float> >( "getPosition", "Torso", FRAME_WORLD, use_sensor );
+      getting_speed_data_ = p_motion_.async<std::vector<float> >( "getRobotVelocity" );
+      fetch_stamp_ = now;
+      is_fetching_ = true;
+    }
+
+    if ( !has_sample_ )
+    {
+      return;
+    }
+    fillMessage( predict( now ) );
+  }
 
   for( message_actions::MessageAction action: actions )
   {
-    callbacks_[action](msg_odom);
+    callbacks_[action](msg_);
 
   }
 }
 
 void OdomConverter::reset( )
 {
+  p_motion_ = helpers::driver::getService( session_, "ALMotion" );
+  has_sample_ = false;
+  correction_x_ = correction_y_ = correction_yaw_ = 0;
+  position_error_.reset();
+  yaw_error_.reset();
+}
+
+void OdomConverter::setPoseCache( const boost::shared_ptr<tools::PoseCache>& pose_cache )
+{
+  pose_cache_ = pose_cache;
 }
 
 } //converter
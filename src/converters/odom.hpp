@@ -22,6 +22,8 @@
 * LOCAL includes
 */
 #include "converter_base.hpp"
+#include "../tools/pose_cache.hpp"
+#include "../tools/statistics.hpp"
 #include <naoqi_driver/message_actions.h>
 #include <naoqi_driver/ros_helpers.hpp>
 
@@ -49,13 +51,65 @@ public:
 
   void reset( );
 
+  void setPoseCache( const boost::shared_ptr<tools::PoseCache>& pose_cache );
+
+  /**
+   * @brief publish at the converter frequency a pose extrapolated from the
+   * last sample and twist, while NAOqi is only polled at sample_frequency
+   * @param correction_time time constant over which the error of the
+   * prediction is absorbed when a new sample arrives
+   * @note the samples then bypass the pose cache, and the prediction error
+   * is logged every minute
+   */
+  void setPrediction( float sample_frequency, float correction_time );
+
 private:
+  /** planar pose and twist of the robot, as given by NAOqi **/
+  struct OdomSample
+  {
+    double x, y, z;
+    double roll, pitch, yaw;
+    double vx, vy, wz;
+    rclcpp::Time stamp;
+  };
+
+  void fillSample( OdomSample& sample, const std::vector<float>& al_odometry_data,
+                   const std::vector<float>& al_speed_data, const rclcpp::Time& stamp );
+
+  /** pose at time t, extrapolated from the last sample and smoothed by the current correction **/
+  OdomSample predict( const rclcpp::Time& t ) const;
+
+  void onSample( const OdomSample& sample );
+
+  void fillMessage( const OdomSample& sample );
 
   /** Motion Proxy **/
   qi::AnyObject p_motion_;
 
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  /** Torso pose shared with the other converters, may be null, unused with prediction **/
+  boost::shared_ptr<tools::PoseCache> pose_cache_;
+
+  CallbackTable<Callback_t> callbacks_;
   nav_msgs::msg::Odometry msg_;
+
+  /** Prediction, disabled when sample_frequency_ is 0 **/
+  float sample_frequency_;
+  float correction_time_;
+  bool has_sample_;
+  OdomSample sample_;
+  bool is_fetching_;
+  rclcpp::Time fetch_stamp_;
+  qi::Future<std::vector<float> > getting_odometry_data_;
+  qi::Future<std::vector<float> > getting_speed_data_;
+
+  /** error of the prediction when a sample arrives, absorbed over correction_time_ **/
+  double correction_x_, correction_y_, correction_yaw_;
+  rclcpp::Time correction_stamp_;
+
+  /** Prediction error statistics **/
+  tools::RunningStats position_error_;
+  tools::RunningStats yaw_error_;
+  tools::StatsReport report_;
 }; // class
 
 } //publisher
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "proprioception.hpp"
+
+/*
+* ROS includes
+*/
+#include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
+
+namespace naoqi
+{
+namespace converter
+{
+
+ProprioceptionConverter::ProprioceptionConverter( const std::string& name, const float& frequency, const TransformCachePtr& transform_cache, const qi::SessionPtr& session ):
+  JointStateConverter( name, frequency, transform_cache, session ),
+  use_motion_angles_( false )
+{
+  imu_locations_.push_back( IMU::TORSO );
+  if ( robot_ == robot::PEPPER )
+  {
+    imu_locations_.push_back( IMU::BASE );
+  }
+
+  msg_odom_.header.frame_id = "odom";
+  msg_odom_.child_frame_id = "base_link";
+}
+
+void ProprioceptionConverter::reset()
+{
+  // urdf, mimic joints and joint names
+  JointStateConverter::reset();
+
+  data_names_list_.clear();
+  imu_index_.clear();
+  position_index_.clear();
+  velocity_index_.clear();
+  effort_index_.clear();
+  msg_imus_.clear();
+  use_motion_angles_ = false;
+
+  data_names_list_.push_back( "DCM/Time" );
+
+  for ( size_t i=0; i<imu_locations_.size(); ++i )
+  {
+    const std::vector<std::string>& keys = ImuConverter::getMemoryKeys( imu_locations_[i] );
+    imu_index_.push_back( data_names_list_.size() );
+    data_names_list_.insert( data_names_list_.end(), keys.begin(), keys.end() );
+
+    sensor_msgs::msg::Imu msg_imu;
+    msg_imu.header.frame_id = (imu_locations_[i] == IMU::BASE) ? "base_footprint" : "base_link";
+    msg_imus_.push_back( msg_imu );
+  }
+
+  // only keep the keys available on this robot, the others are filled with NaN
+  for ( std::vector<std::string>::const_iterator itName = msg_joint_states_.name.begin();
+        itName != msg_joint_states_.name.end();
+        ++itName )
+  {
+    const std::string position_key = "Device/SubDeviceList/" + (*itName) + "/Position/Sensor/Value";
+    if ( helpers::driver::hasMemoryKey( session_, position_key ) )
+    {
+      position_index_.push_back( data_names_list_.size() );
+      data_names_list_.push_back( position_key );
+    }
+    else
+    {
+      position_index_.push_back( -1 );
+      use_motion_angles_ = true;
+    }
+
+    const std::string velocity_key = "Motion/Velocity/Sensor/" + (*itName);
+    if ( helpers::driver::hasMemoryKey( session_, velocity_key ) )
+    {
+      velocity_index_.push_back( data_names_list_.size() );
+      data_names_list_.push_back( velocity_key );
+    }
+    else
+    {
+      velocity_index_.push_back( -1 );
+    }
+
+    const std::string effort_key = "Motion/Torque/Sensor/" + (*itName);
+    if ( helpers::driver::hasMemoryKey( session_, effort_key ) )
+    {
+      effort_index_.push_back( data_names_list_.size() );
+      data_names_list_.push_back( effort_key );
+    }
+    else
+    {
+      effort_index_.push_back( -1 );
+    }
+  }
+
+  if ( use_motion_angles_ )
+  {
+    std::cout << "Proprioception: some joint position keys are missing, angles are read from ALMotion" << std::endl;
+  }
+}
+
+void ProprioceptionConverter::registerCallback( const message_actions::MessageAction action, Callback_t cb )
+{
+  callbacks_[action] = cb;
+}
+
+void ProprioceptionConverter::setImuLocations( const std::vector<IMU::Location>& locations )
+{
+  imu_locations_ = locations;
+}
+
+void ProprioceptionConverter::setClockSync( const boost::shared_ptr<tools::ClockSync>& clock_sync )
+{
+  clock_sync_ = clock_sync;
+}
+
+void ProprioceptionConverter::callAll( const std::vector<message_actions::MessageAction>& actions )
+{
+  // the motion calls run while memory is read
+  rclcpp::Time odom_requested;
+  qi::Future<std::vector<float> > getting_odometry_data = pose_cache_
+    ? pose_cache_->getTorsoPose( odom_requested )
+    : p_motion_.async<std::vector<float> >( "getPosition", "Torso", 1, true );
+  auto getting_speed_data = p_motion_.async<std::vector<float> >( "getRobotVelocity" );
+  qi::Future<std::vector<double> > getting_angles;
+  if ( use_motion_angles_ )
+  {
+    getting_angles = p_motion_.async<std::vector<double> >( "getAngles", "Body", true );
+  }
+
+  int64_t dcm_time_ms = 0;
+  std::vector<float> mem_data;
+  try {
+    qi::AnyValue anyvalues = p_memory_.call<qi::AnyValue>( "getListData", data_names_list_ );
+    qi::AnyReferenceVector anyrefs = anyvalues.asListValuePtr();
+    // DCM/Time does not fit in a float
+    dcm_time_ms = anyrefs[0].content().toInt();
+    for ( size_t i=0; i<anyrefs.size(); ++i )
+    {
+      mem_data.push_back( (i == 0) ? 0.f : anyrefs[i].content().toFloat() );
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Exception caught in ProprioceptionConverter: " << e.what() << std::endl;
+    return;
+  }
+
+  const rclcpp::Time& stamp = clock_sync_ ? clock_sync_->fromDcmTime( dcm_time_ms ) : helpers::Time::now();
+
+  /**
+   * JOINTS
+   */
+  std::vector<double> al_joint_angles;
+  if ( use_motion_angles_ )
+  {
+    al_joint_angles = getting_angles.value();
+  }
+  std::vector<double> al_joint_velocities( position_index_.size(), std::numeric_limits<double>::quiet_NaN() );
+  std::vector<double> al_joint_torques( position_index_.size(), std::numeric_limits<double>::quiet_NaN() );
+  al_joint_angles.resize( position_index_.size(), std::numeric_limits<double>::quiet_NaN() );
+  for ( size_t i=0; i<position_index_.size(); ++i )
+  {
+    if ( position_index_[i] >= 0 )
+      al_joint_angles[i] = mem_data[position_index_[i]];
+    if ( velocity_index_[i] >= 0 )
+      al_joint_velocities[i] = mem_data[velocity_index_[i]];
+    if ( effort_index_[i] >= 0 )
+      al_joint_torques[i] = mem_data[effort_index_[i]];
+  }
+
+  std::vector<float> al_odometry_data = getting_odometry_data.value();
+  std::vector<float> al_speed_data = getting_speed_data.value();
+
+  // a pose reused from the cache was sampled when it was requested
+  updateState( stamp, al_joint_angles, al_joint_velocities, al_joint_torques, al_odometry_data,
+               pose_cache_ ? odom_requested : stamp );
+
+  /**
+   * IMU
+   */
+  for ( size_t i=0; i<msg_imus_.size(); ++i )
+  {
+    msg_imus_[i].header.stamp = stamp;
+    ImuConverter::fillMessage( msg_imus_[i], mem_data, imu_index_[i] );
+  }
+
+  /**
+   * ODOMETRY
+   */
+  tf2::Quaternion tf_quat;
+  tf_quat.setRPY( al_odometry_data[3], al_odometry_data[4], al_odometry_data[5] );
+  msg_odom_.header.stamp = stamp;
+  msg_odom_.pose.pose.orientation = tf2::toMsg( tf_quat );
+  msg_odom_.pose.pose.position.x = al_odometry_data[0];
+  msg_odom_.pose.pose.position.y = al_odometry_data[1];
+  msg_odom_.pose.pose.position.z = al_odometry_data[2];
+
+  msg_odom_.twist.twist.linear.x = al_speed_data[0];
+  msg_odom_.twist.twist.linear.y = al_speed_data[1];
+  msg_odom_.twist.twist.linear.z = 0;
+  msg_odom_.twist.twist.angular.x = 0;
+  msg_odom_.twist.twist.angular.y = 0;
+  msg_odom_.twist.twist.angular.z = al_speed_data[2];
+
+  for( message_actions::MessageAction action: actions )
+  {
+    callbacks_[action]( msg_joint_states_, tf_transforms_, msg_imus_, msg_odom_ );
+  }
+}
+
+} //converter
+} // naoqi
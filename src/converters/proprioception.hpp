@@ -0,0 +1,103 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef PROPRIOCEPTION_CONVERTER_HPP
+#define PROPRIOCEPTION_CONVERTER_HPP
+
+/*
+* LOCAL includes
+*/
+#include "joint_state.hpp"
+#include "imu.hpp"
+#include "../tools/clock_sync.hpp"
+
+/*
+* ROS includes
+*/
+#include <sensor_msgs/msg/imu.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+
+namespace naoqi
+{
+namespace converter
+{
+
+/**
+ * @brief Converter gathering joint states, transforms, inertial units and
+ * odometry in one tick. Sensor values are read with a single getListData
+ * and every message is stamped with the same DCM/Time.
+ */
+class ProprioceptionConverter : public JointStateConverter
+{
+
+  typedef boost::function<void(sensor_msgs::msg::JointState&,
+                               std::vector<geometry_msgs::msg::TransformStamped>&,
+                               std::vector<sensor_msgs::msg::Imu>&,
+                               nav_msgs::msg::Odometry&) > Callback_t;
+
+public:
+  ProprioceptionConverter( const std::string& name, const float& frequency, const TransformCachePtr& transform_cache, const qi::SessionPtr& session );
+
+  virtual void reset( );
+
+  void registerCallback( const message_actions::MessageAction action, Callback_t cb );
+
+  void callAll( const std::vector<message_actions::MessageAction>& actions );
+
+  void setClockSync( const boost::shared_ptr<tools::ClockSync>& clock_sync );
+
+  /**
+   * @brief choose the inertial units to read, before the converter is reset
+   */
+  void setImuLocations( const std::vector<IMU::Location>& locations );
+
+  /**
+   * @brief locations of the inertial units, in the order of the Imu messages
+   */
+  inline const std::vector<IMU::Location>& imuLocations() const
+  {
+    return imu_locations_;
+  }
+
+private:
+  /** keys read with getListData, DCM/Time first */
+  std::vector<std::string> data_names_list_;
+
+  /** index in data_names_list_ of each inertial unit and joint sensor, -1 if not available */
+  std::vector<IMU::Location> imu_locations_;
+  std::vector<int> imu_index_;
+  std::vector<int> position_index_;
+  std::vector<int> velocity_index_;
+  std::vector<int> effort_index_;
+
+  /** fall back on ALMotion for the angles if a position key is missing */
+  bool use_motion_angles_;
+
+  boost::shared_ptr<tools::ClockSync> clock_sync_;
+
+  std::vector<sensor_msgs::msg::Imu> msg_imus_;
+  nav_msgs::msg::Odometry msg_odom_;
+
+  /** Registered Callbacks **/
+  CallbackTable<Callback_t> callbacks_;
+
+}; // class
+
+} //converter
+} // naoqi
+
+#endif
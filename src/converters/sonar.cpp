@@ -29,13 +29,13 @@ namespace converter
 
 SonarConverter::SonarConverter( const std::string& name, const float& frequency, const qi::SessionPtr& session )
   : BaseConverter( name, frequency, session ),
-    p_memory_( session->service("ALMemory").value() ),
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) ),
     is_subscribed_(false)
 {
   // Only create a sonar proxy if NAOqi < 2.9
   if (helpers::driver::isNaoqiVersionLesser(naoqi_version_, 2, 9))
   {
-    p_sonar_ = session->service("ALSonar").value();
+    p_sonar_ = helpers::driver::getService( session, "ALSonar" );
   }
 
   std::vector<std::string> keys;
@@ -119,11 +119,21 @@ void SonarConverter::callAll( const std::vector<message_actions::MessageAction>&
 
 void SonarConverter::reset( )
 {
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+
   // No need to unsubscribe if NAOqi > 2.9
-  if (is_subscribed_ && helpers::driver::isNaoqiVersionLesser(naoqi_version_, 2, 9))
+  if (helpers::driver::isNaoqiVersionLesser(naoqi_version_, 2, 9))
   {
-    p_sonar_.call<void>("unsubscribe", "ROS");
-    is_subscribed_ = false;
+    p_sonar_ = helpers::driver::getService( session_, "ALSonar" );
+    if (is_subscribed_)
+    {
+      try {
+        p_sonar_.call<void>("unsubscribe", "ROS");
+      } catch (const std::exception& e) {
+        // NAOqi restarted, the subscription is already gone
+      }
+      is_subscribed_ = false;
+    }
   }
 }
 
@@ -54,7 +54,7 @@ public:
 
 
 private:
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
 
   /** Sonar (Proxy) configurations */
   qi::AnyObject p_sonar_;
@@ -59,7 +59,7 @@ public:
 
 private:
   /** Registered Callbacks **/
-  std::map<message_actions::MessageAction, Callback_t> callbacks_;
+  CallbackTable<Callback_t> callbacks_;
   T msg_;
 };
 
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+ * BOOST includes
+ */
+#include <boost/make_shared.hpp>
+
+/*
+ * ROS includes
+ */
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_components/register_node_macro.hpp>
+
+/*
+ * ALDEBARAN includes
+ */
+#include <qi/session.hpp>
+
+/*
+ * LOCAL includes
+ */
+#include <naoqi_driver/naoqi_driver.hpp>
+#include <naoqi_driver/ros_helpers.hpp>
+
+namespace naoqi
+{
+
+/**
+* @brief Driver loaded in a component container, so that nodes of the same
+* process receive the camera, audio and sensor messages through intra-process
+* communication, without serialization, when use_intra_process_comms is set.
+* It connects its own qi session and runs the ROS loop from a timer of the
+* node, on the executor of the container: the loop, which replaces the proxies
+* on reconnection, and the subscriber, service and action callbacks that use
+* them share the default callback group, so they never run concurrently.
+*/
+class DriverComponent
+{
+public:
+  explicit DriverComponent( const rclcpp::NodeOptions& options ):
+    driver_( boost::make_shared<Driver>( options ) ),
+    session_( qi::makeSession() )
+  {
+    helpers::Node::setNode( driver_ );
+    driver_->disableSpinning();
+    if ( !driver_->connectQiSession( session_ ) )
+    {
+      throw std::runtime_error( "naoqi_driver could not connect to the robot" );
+    }
+    driver_->init();
+    loop_ = driver_->create_wall_timer( std::chrono::milliseconds( 1 ),
+                                        [this]() { driver_->spinOnce(); } );
+  }
+
+  ~DriverComponent()
+  {
+    loop_->cancel();
+    driver_->stop();
+    session_->close();
+  }
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr get_node_base_interface() const
+  {
+    return driver_->get_node_base_interface();
+  }
+
+private:
+  boost::shared_ptr<Driver> driver_;
+  qi::SessionPtr session_;
+  rclcpp::TimerBase::SharedPtr loop_;
+};
+
+} // naoqi
+
+RCLCPP_COMPONENTS_REGISTER_NODE(naoqi::DriverComponent)
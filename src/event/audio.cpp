@@ -33,10 +33,10 @@ static const std::string AUDIO_EXTRACTOR_NAME = "ROS-Driver-Audio";
 
 AudioEventRegister::AudioEventRegister( const std::string& name, const float& frequency, const qi::SessionPtr& session )
   : session_(session),
-    publisher_(name),
+    publisher_(name, rclcpp::SensorDataQoS()),
     recorder_(name),
     converter_(name, frequency, session),
-    p_audio_( session->service("ALAudioDevice").value()),
+    p_audio_( helpers::driver::getService( session, "ALAudioDevice" )),
     serviceId(0),
     isStarted_(false),
     isPublishing_(false),
@@ -45,7 +45,10 @@ AudioEventRegister::AudioEventRegister( const std::string& name, const float& fr
 {
   // _getMicrophoneConfig is used for NAOqi < 2.9, _getConfigMap for NAOqi > 2.9
   int micConfig;
-  auto robotModel = session->service("ALRobotModel").value();
+  auto robotModel = helpers::driver::getService( session, "ALRobotModel" );
+  // the configuration is requested while the version is checked
+  qi::Future<std::map<std::string, std::string> > getting_config_map =
+    robotModel.async<std::map<std::string, std::string> >("_getConfigMap");
   const auto &naoqiVersion = helpers::driver::getNaoqiVersion(session);
   if (helpers::driver::isNaoqiVersionLesser(naoqiVersion, 2, 8))
   {
@@ -53,7 +56,7 @@ AudioEventRegister::AudioEventRegister( const std::string& name, const float& fr
   }
   else
   {
-    auto config_map = robotModel.call<std::map<std::string, std::string> >("_getConfigMap");
+    auto config_map = getting_config_map.value();
     micConfig = std::atoi(config_map["RobotConfig/Head/Device/Micro/Version"].c_str());
   }
 
@@ -129,6 +132,27 @@ void AudioEventRegister::stopProcess()
   }
 }
 
+void AudioEventRegister::reconnect()
+{
+  bool was_started;
+  {
+    boost::mutex::scoped_lock reconnect_lock(subscription_mutex_);
+    p_audio_ = helpers::driver::getService( session_, "ALAudioDevice" );
+    if (serviceId)
+    {
+      // may already be gone with the former connection, the error is ignored
+      session_->unregisterService(serviceId).wait();
+      serviceId = 0;
+    }
+    was_started = isStarted_;
+    isStarted_ = false;
+  }
+  if (was_started)
+  {
+    startProcess();
+  }
+}
+
 void AudioEventRegister::writeDump(const rclcpp::Time& time)
 {
   if (isStarted_)
@@ -160,6 +184,11 @@ void AudioEventRegister::isDumping(bool state)
   isDumping_ = state;
 }
 
+void AudioEventRegister::setClockSync(const boost::shared_ptr<tools::ClockSync>& clock_sync)
+{
+  clock_sync_ = clock_sync;
+}
+
 void AudioEventRegister::registerCallback()
 {
 }
@@ -172,6 +201,16 @@ void AudioEventRegister::processRemote(int nbOfChannels, int samplesByChannel, q
 {
   naoqi_bridge_msgs::msg::AudioBuffer msg = naoqi_bridge_msgs::msg::AudioBuffer();
   msg.header.stamp = helpers::Time::now();
+  if (clock_sync_) {
+    // use the time given by ALAudioDevice for the buffer, mapped to the host clock
+    try {
+      qi::AnyReferenceVector timestamp = altimestamp.asListValuePtr();
+      const int64_t remote_ns = timestamp[0].content().toInt() * 1000000000 + timestamp[1].content().toInt() * 1000;
+      msg.header.stamp = clock_sync_->fromRemoteTime("audio", remote_ns, msg.header.stamp);
+    } catch (const std::exception& e) {
+      // keep the reception time
+    }
+  }
   msg.frequency = 48000;
   msg.channel_map = channelMap;
 
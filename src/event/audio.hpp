@@ -40,6 +40,8 @@
 #include "../src/publishers/basic.hpp"
 // Recorder
 #include "../recorder/basic_event.hpp"
+// Tools
+#include "../tools/clock_sync.hpp"
 
 namespace naoqi
 {
@@ -68,6 +70,8 @@ public:
   void startProcess();
   void stopProcess();
 
+  void reconnect();
+
   void writeDump(const rclcpp::Time& time);
   void setBufferDuration(float duration);
 
@@ -75,6 +79,8 @@ public:
   void isPublishing(bool state);
   void isDumping(bool state);
 
+  void setClockSync(const boost::shared_ptr<tools::ClockSync>& clock_sync);
+
   void processRemote(int nbOfChannels, int samplesByChannel, qi::AnyValue altimestamp, qi::AnyValue buffer);
 
 private:
@@ -91,6 +97,7 @@ private:
   qi::FutureSync<qi::AnyObject> p_audio_extractor_request;
   std::vector<uint8_t> channelMap;
   unsigned int serviceId;
+  boost::shared_ptr<tools::ClockSync> clock_sync_;
 
   boost::mutex subscription_mutex_;
   boost::mutex processing_mutex_;
@@ -31,6 +31,8 @@
 #include <naoqi_driver/tools.hpp>
 #include <naoqi_driver/recorder/globalrecorder.hpp>
 
+#include "../helpers/driver_helpers.hpp"
+
 namespace naoqi
 {
 
@@ -60,6 +62,8 @@ public:
   void startProcess();
   void stopProcess();
 
+  void reconnect();
+
   void writeDump(const rclcpp::Time& time);
   void setBufferDuration(float duration);
 
@@ -77,6 +81,7 @@ private:
   boost::shared_ptr<Publisher> publisher_;
   boost::shared_ptr<Recorder> recorder_;
 
+  qi::SessionPtr session_;
   qi::AnyObject p_memory_;
   qi::AnyObject signal_;
   qi::SignalLink signalID_;
@@ -38,7 +38,8 @@ EventRegister<Converter, Publisher, Recorder>::EventRegister()
 template <typename Converter, typename Publisher, typename Recorder>
 EventRegister<Converter, Publisher, Recorder>::EventRegister( const std::string& key, const qi::SessionPtr& session )
   : key_(key),
-    p_memory_( session->service("ALMemory").value()),
+    session_(session),
+    p_memory_( helpers::driver::getService( session, "ALMemory" )),
     isStarted_(false),
     isPublishing_(false),
     isRecording_(false),
@@ -95,6 +96,21 @@ void EventRegister<Converter, Publisher, Recorder>::stopProcess()
   }
 }
 
+template <typename Converter, typename Publisher, typename Recorder>
+void EventRegister<Converter, Publisher, Recorder>::reconnect()
+{
+  converter_->reset();
+
+  boost::mutex::scoped_lock reconnect_lock(mutex_);
+  // the link to the former subscriber died with the session
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+  signal_ = p_memory_.call<qi::AnyObject>("subscriber", key_);
+  if (isStarted_)
+  {
+    registerCallback();
+  }
+}
+
 template <typename Converter, typename Publisher, typename Recorder>
 void EventRegister<Converter, Publisher, Recorder>::writeDump(const rclcpp::Time& time)
 {
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <iostream>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <qi/anyobject.hpp>
+
+#include <naoqi_driver/recorder/globalrecorder.hpp>
+#include <naoqi_driver/message_actions.h>
+
+#include "imu.hpp"
+#include "../tools/from_any_value.hpp"
+
+namespace naoqi
+{
+
+ImuEventRegister::ImuEventRegister( const std::vector<converter::IMU::Location>& locations,
+                                    const std::vector<std::string>& topics,
+                                    const float& frequency,
+                                    const qi::SessionPtr& session )
+  : session_(session),
+    p_memory_( helpers::driver::getService( session, "ALMemory" ) ),
+    frequency_(frequency),
+    has_last_dcm_time_(false),
+    last_dcm_time_ms_(0),
+    duplicates_(0),
+    isStarted_(false),
+    isPublishing_(false),
+    isRecording_(false),
+    isDumping_(false)
+{
+  data_names_list_.push_back("DCM/Time");
+  for (size_t i=0; i<locations.size() && i<topics.size(); ++i)
+  {
+    const std::vector<std::string>& keys = converter::ImuConverter::getMemoryKeys(locations[i]);
+    data_names_list_.insert(data_names_list_.end(), keys.begin(), keys.end());
+
+    sensor_msgs::msg::Imu msg;
+    msg.header.frame_id = (locations[i] == converter::IMU::BASE) ? "base_footprint" : "base_link";
+    msgs_.push_back(msg);
+
+    publishers_.push_back( boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::Imu> >(topics[i], rclcpp::SensorDataQoS()) );
+    recorders_.push_back( boost::make_shared<recorder::BasicEventRecorder<sensor_msgs::msg::Imu> >(topics[i]) );
+  }
+}
+
+ImuEventRegister::~ImuEventRegister()
+{
+  stopProcess();
+}
+
+void ImuEventRegister::resetPublisher(rclcpp::Node* node)
+{
+  for (size_t i=0; i<publishers_.size(); ++i)
+  {
+    publishers_[i]->reset(node);
+  }
+}
+
+void ImuEventRegister::resetRecorder( boost::shared_ptr<naoqi::recorder::GlobalRecorder> gr )
+{
+  for (size_t i=0; i<recorders_.size(); ++i)
+  {
+    recorders_[i]->reset(gr, frequency_);
+  }
+}
+
+void ImuEventRegister::startProcess()
+{
+  boost::mutex::scoped_lock start_lock(subscription_mutex_);
+  if (!isStarted_)
+  {
+    has_last_dcm_time_ = false;
+    thread_ = boost::thread( &ImuEventRegister::loop, this );
+    std::cout << "High rate IMU: Start" << std::endl;
+    isStarted_ = true;
+  }
+}
+
+void ImuEventRegister::stopProcess()
+{
+  boost::mutex::scoped_lock stop_lock(subscription_mutex_);
+  if (isStarted_)
+  {
+    thread_.interrupt();
+    thread_.join();
+    std::cout << "High rate IMU: Stop" << std::endl;
+    isStarted_ = false;
+  }
+}
+
+void ImuEventRegister::reconnect()
+{
+  const bool was_started = isStarted_;
+  stopProcess();
+  p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+  if (was_started)
+  {
+    startProcess();
+  }
+}
+
+void ImuEventRegister::writeDump(const rclcpp::Time& time)
+{
+  if (isStarted_)
+  {
+    for (size_t i=0; i<recorders_.size(); ++i)
+    {
+      recorders_[i]->writeDump(time);
+    }
+  }
+}
+
+void ImuEventRegister::setBufferDuration(float duration)
+{
+  for (size_t i=0; i<recorders_.size(); ++i)
+  {
+    recorders_[i]->setBufferDuration(duration);
+  }
+}
+
+void ImuEventRegister::isRecording(bool state)
+{
+  boost::mutex::scoped_lock rec_lock(processing_mutex_);
+  isRecording_ = state;
+}
+
+void ImuEventRegister::isPublishing(bool state)
+{
+  boost::mutex::scoped_lock pub_lock(processing_mutex_);
+  isPublishing_ = state;
+}
+
+void ImuEventRegister::isDumping(bool state)
+{
+  boost::mutex::scoped_lock dump_lock(processing_mutex_);
+  isDumping_ = state;
+}
+
+void ImuEventRegister::setClockSync(const boost::shared_ptr<tools::ClockSync>& clock_sync)
+{
+  clock_sync_ = clock_sync;
+}
+
+void ImuEventRegister::loop()
+{
+  const boost::chrono::nanoseconds period( static_cast<int64_t>(1e9 / frequency_) );
+  boost::chrono::steady_clock::time_point next = boost::chrono::steady_clock::now();
+  try
+  {
+    while (true)
+    {
+      onSample();
+      // keep the polling rate, whatever the time spent reading
+      next += period;
+      const boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+      if (next < now)
+      {
+        next = now;
+      }
+      boost::this_thread::sleep_until(next);
+    }
+  }
+  catch (const boost::thread_interrupted&)
+  {
+  }
+}
+
+void ImuEventRegister::onSample()
+{
+  int64_t dcm_time_ms = 0;
+  std::vector<float> mem_data;
+  try {
+    qi::AnyValue anyvalues = p_memory_.call<qi::AnyValue>("getListData", data_names_list_);
+    // DCM/Time does not fit in a float
+    dcm_time_ms = anyvalues.asListValuePtr()[0].content().toInt();
+    tools::fromAnyValueToFloatVector(anyvalues, mem_data);
+  } catch (const std::exception& e) {
+    std::cerr << "Exception caught in ImuEventRegister: " << e.what() << std::endl;
+    return;
+  }
+
+  // the DCM did not refresh the values since the last read
+  if (has_last_dcm_time_ && dcm_time_ms == last_dcm_time_ms_)
+  {
+    ++duplicates_;
+    return;
+  }
+  if (has_last_dcm_time_)
+  {
+    sample_period_.add((dcm_time_ms - last_dcm_time_ms_) * 1e-3);
+  }
+  has_last_dcm_time_ = true;
+  last_dcm_time_ms_ = dcm_time_ms;
+
+  const rclcpp::Time& stamp = clock_sync_ ? clock_sync_->fromDcmTime(dcm_time_ms) : helpers::Time::now();
+  for (size_t i=0; i<msgs_.size(); ++i)
+  {
+    msgs_[i].header.stamp = stamp;
+    // memData[0] is DCM/Time, then 9 values per inertial unit
+    converter::ImuConverter::fillMessage(msgs_[i], mem_data, 1 + 9*i);
+  }
+
+  if (report_.due())
+  {
+    RCLCPP_DEBUG(helpers::Node::get_logger(), "High rate IMU: %zu samples, period mean %.2f ms, max %.2f ms, %zu duplicate reads dropped",
+                 sample_period_.count(), sample_period_.mean() * 1e3, sample_period_.max() * 1e3, duplicates_);
+    sample_period_.reset();
+    duplicates_ = 0;
+  }
+
+  boost::mutex::scoped_lock callback_lock(processing_mutex_);
+  for (size_t i=0; i<msgs_.size(); ++i)
+  {
+    if ( isPublishing_ && publishers_[i]->isSubscribed() )
+    {
+      publishers_[i]->publish(msgs_[i]);
+    }
+    if ( isRecording_ )
+    {
+      recorders_[i]->write(msgs_[i]);
+    }
+    if ( !isDumping_ )
+    {
+      recorders_[i]->bufferize(msgs_[i]);
+    }
+  }
+}
+
+}//namespace
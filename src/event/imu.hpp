@@ -0,0 +1,120 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IMU_EVENT_REGISTER_HPP
+#define IMU_EVENT_REGISTER_HPP
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <qi/session.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/imu.hpp>
+
+#include <naoqi_driver/tools.hpp>
+#include <naoqi_driver/recorder/globalrecorder.hpp>
+
+// Converter
+#include "../src/converters/imu.hpp"
+// Publisher
+#include "../src/publishers/basic.hpp"
+// Recorder
+#include "../recorder/basic_event.hpp"
+// Tools
+#include "../tools/clock_sync.hpp"
+#include "../tools/statistics.hpp"
+
+namespace naoqi
+{
+
+/**
+* @brief High rate inertial units, polled on a dedicated thread.
+* All the inertial units are read with one getListData and stamped with the
+* DCM/Time of the sample. Reads returning the same DCM/Time as the previous
+* one are dropped.
+*/
+class ImuEventRegister
+{
+
+public:
+
+  ImuEventRegister( const std::vector<converter::IMU::Location>& locations,
+                    const std::vector<std::string>& topics,
+                    const float& frequency,
+                    const qi::SessionPtr& session );
+  ~ImuEventRegister();
+
+  void resetPublisher( rclcpp::Node* node );
+  void resetRecorder( boost::shared_ptr<naoqi::recorder::GlobalRecorder> gr );
+
+  void startProcess();
+  void stopProcess();
+
+  void reconnect();
+
+  void writeDump(const rclcpp::Time& time);
+  void setBufferDuration(float duration);
+
+  void isRecording(bool state);
+  void isPublishing(bool state);
+  void isDumping(bool state);
+
+  void setClockSync(const boost::shared_ptr<tools::ClockSync>& clock_sync);
+
+private:
+  void loop();
+  void onSample();
+
+private:
+  std::vector< boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::Imu> > > publishers_;
+  std::vector< boost::shared_ptr<recorder::BasicEventRecorder<sensor_msgs::msg::Imu> > > recorders_;
+
+  qi::SessionPtr session_;
+  qi::AnyObject p_memory_;
+  float frequency_;
+
+  /** keys read with getListData, DCM/Time first, then each inertial unit */
+  std::vector<std::string> data_names_list_;
+  std::vector<sensor_msgs::msg::Imu> msgs_;
+
+  boost::shared_ptr<tools::ClockSync> clock_sync_;
+
+  bool has_last_dcm_time_;
+  int64_t last_dcm_time_ms_;
+  size_t duplicates_;
+  tools::RunningStats sample_period_;
+  tools::StatsReport report_;
+
+  boost::thread thread_;
+  boost::mutex subscription_mutex_;
+  boost::mutex processing_mutex_;
+
+  bool isStarted_;
+  bool isPublishing_;
+  bool isRecording_;
+  bool isDumping_;
+
+}; // class
+
+} //naoqi
+
+#endif
@@ -39,7 +39,8 @@ TouchEventRegister<T>::TouchEventRegister()
 
 template<class T>
 TouchEventRegister<T>::TouchEventRegister( const std::string& name, const std::vector<std::string> keys, const float& frequency, const qi::SessionPtr& session )
-  : p_memory_( session->service("ALMemory").value()),
+  : session_(session),
+    p_memory_( helpers::driver::getService( session, "ALMemory" )),
     isStarted_(false),
     isPublishing_(false),
     isRecording_(false),
@@ -117,6 +118,24 @@ void TouchEventRegister<T>::stopProcess()
   }
 }
 
+template<class T>
+void TouchEventRegister<T>::reconnect()
+{
+  bool was_started;
+  {
+    boost::mutex::scoped_lock reconnect_lock(mutex_);
+    // the former subscriptions died with the session, nothing to disconnect
+    p_memory_ = helpers::driver::getService( session_, "ALMemory" );
+    subscriptions_.clear();
+    was_started = isStarted_;
+    isStarted_ = false;
+  }
+  if (was_started)
+  {
+    startProcess();
+  }
+}
+
 template<class T>
 void TouchEventRegister<T>::writeDump(const rclcpp::Time& time)
 {
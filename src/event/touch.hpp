@@ -71,6 +71,8 @@ public:
   void startProcess();
   void stopProcess();
 
+  void reconnect();
+
   void writeDump(const rclcpp::Time& time);
   void setBufferDuration(float duration);
 
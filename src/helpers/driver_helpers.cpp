@@ -18,6 +18,7 @@
 #include "driver_helpers.hpp"
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 
 namespace naoqi
 {
@@ -29,24 +30,60 @@ namespace pt = boost::property_tree;
 
 static pt::ptree empty_ptree;
 
-/** Function that returns the type of a robot
- */
-static naoqi_bridge_msgs::msg::RobotInfo& getRobotInfoLocal( const qi::SessionPtr& session)
+/** Robot metadata and service proxies, fetched once for the session they were requested on */
+struct SessionCache
 {
-  static naoqi_bridge_msgs::msg::RobotInfo info;
-  static qi::Url robot_url;
-
-  if (robot_url == session->url())
+  SessionCache():
+    has_version( false ),
+    has_info( false ),
+    robot( robot::UNIDENTIFIED ),
+    rpc_count( 0 ),
+    cache_hits( 0 )
+  {}
+
+  boost::recursive_mutex mutex;
+  qi::Url url;
+
+  bool has_version;
+  robot::NaoqiVersion version;
+  bool has_info;
+  naoqi_bridge_msgs::msg::RobotInfo info;
+  robot::Robot robot;
+  std::map<std::string, qi::Future<qi::AnyObject> > services;
+
+  /** round-trips done to fill the cache, and the ones it saved */
+  size_t rpc_count;
+  size_t cache_hits;
+};
+
+static SessionCache session_cache;
+
+/** Cache of the given session, emptied if the session now points to another robot */
+static SessionCache& cacheFor( const qi::SessionPtr& session )
+{
+  if ( session_cache.url != session->url() )
   {
-    return info;
+    session_cache.url = session->url();
+    session_cache.has_version = false;
+    session_cache.has_info = false;
+    session_cache.robot = robot::UNIDENTIFIED;
+    session_cache.services.clear();
   }
+  return session_cache;
+}
 
-  robot_url = session->url();
+/** Function that returns the type of a robot
+ */
+static naoqi_bridge_msgs::msg::RobotInfo getRobotInfoLocal( const qi::SessionPtr& session)
+{
+  naoqi_bridge_msgs::msg::RobotInfo info;
 
   // Get the robot type
   std::cout << "Receiving information about robot model" << std::endl;
-  qi::AnyObject p_memory = session->service("ALMemory").value();
+  qi::AnyObject p_memory = getService( session, "ALMemory" );
+  ++session_cache.rpc_count;
   std::string robot = p_memory.call<std::string>("getData", "RobotConfig/Body/Type" );
+  ++session_cache.rpc_count;
   std::string hardware_version = p_memory.call<std::string>("getData", "RobotConfig/Body/BaseVersion" );
   robot::NaoqiVersion naoqi_version = getNaoqiVersion(session);
   std::transform(robot.begin(), robot.end(), robot.begin(), ::tolower);
@@ -72,9 +109,10 @@ static naoqi_bridge_msgs::msg::RobotInfo& getRobotInfoLocal( const qi::SessionPt
   std::cout << BOLDCYAN << " / " << naoqi_version.text << RESETCOLOR << std::endl;
 
   // Get the data from RobotConfig
-  qi::AnyObject p_motion = session->service("ALMotion").value();
+  qi::AnyObject p_motion = getService( session, "ALMotion" );
   try
   {
+    ++session_cache.rpc_count;
     std::vector<std::vector<qi::AnyValue> > config = p_motion.call<std::vector<std::vector<qi::AnyValue> > >("getRobotConfig");
 
     // TODO, fill with the proper string matches from http://doc.aldebaran.com/2-1/naoqi/motion/tools-general-api.html#ALMotionProxy::getRobotConfig
@@ -186,10 +224,11 @@ static naoqi_bridge_msgs::msg::RobotInfo& getRobotInfoLocal( const qi::SessionPt
   {
     // NAOqi 2.9
     std::cout << "ALMotion.getRobotConfig failed (" /*<< e.what()*/ << "), trying with newer service ALRobotModel" << std::endl;
-    auto p_robot_model = session->service("ALRobotModel").value();
+    auto p_robot_model = getService( session, "ALRobotModel" );
 
     try
     {
+      ++session_cache.rpc_count;
       info.model = p_robot_model.call<std::string>("getRobotType");
     }
     catch (const std::exception &e)
@@ -199,6 +238,7 @@ static naoqi_bridge_msgs::msg::RobotInfo& getRobotInfoLocal( const qi::SessionPt
 
     try
     {
+      ++session_cache.rpc_count;
       info.number_of_legs = p_robot_model.call<bool>("hasLegs") ? 1 : 0;
     }
     catch (const std::exception &e)
@@ -208,6 +248,7 @@ static naoqi_bridge_msgs::msg::RobotInfo& getRobotInfoLocal( const qi::SessionPt
 
     try
     {
+      ++session_cache.rpc_count;
       std::istringstream config_data(p_robot_model.call<std::string>("getConfig"));
       pt::ptree tree;
       pt::read_xml(config_data, tree);
@@ -242,19 +283,22 @@ static naoqi_bridge_msgs::msg::RobotInfo& getRobotInfoLocal( const qi::SessionPt
   return info;
 }
 
-const robot::Robot& getRobot( const qi::SessionPtr& session )
+robot::Robot getRobot( const qi::SessionPtr& session )
 {
-  static robot::Robot robot = robot::UNIDENTIFIED;
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  SessionCache& cache = cacheFor( session );
+  robot::Robot& robot = cache.robot;
+  const naoqi_bridge_msgs::msg::RobotInfo info = getRobotInfo(session);
 
-  if ( getRobotInfo(session).type == naoqi_bridge_msgs::msg::RobotInfo::NAO )
+  if ( info.type == naoqi_bridge_msgs::msg::RobotInfo::NAO )
   {
     robot = robot::NAO;
   }
-  if ( getRobotInfo(session).type == naoqi_bridge_msgs::msg::RobotInfo::PEPPER )
+  if ( info.type == naoqi_bridge_msgs::msg::RobotInfo::PEPPER )
   {
     robot = robot::PEPPER;
   }
-  if ( getRobotInfo(session).type == naoqi_bridge_msgs::msg::RobotInfo::ROMEO )
+  if ( info.type == naoqi_bridge_msgs::msg::RobotInfo::ROMEO )
   {
     robot = robot::ROMEO;
   }
@@ -266,15 +310,24 @@ const robot::Robot& getRobot( const qi::SessionPtr& session )
  * @brief Function that retrieves the NAOqi version of the robot
  *
  * @param session
- * @return const robot::NaoqiVersion&
+ * @return robot::NaoqiVersion
  */
-const robot::NaoqiVersion& getNaoqiVersion( const qi::SessionPtr& session )
+robot::NaoqiVersion getNaoqiVersion( const qi::SessionPtr& session )
 {
-  static robot::NaoqiVersion naoqi_version;
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  SessionCache& cache = cacheFor( session );
+  robot::NaoqiVersion& naoqi_version = cache.version;
+  if ( cache.has_version )
+  {
+    ++cache.cache_hits;
+    return naoqi_version;
+  }
 
   try {
-    qi::AnyObject p_system = session->service("ALSystem").value();
+    qi::AnyObject p_system = getService( session, "ALSystem" );
+    ++cache.rpc_count;
     naoqi_version.text = p_system.call<std::string>("systemVersion");
+    cache.has_version = true;
 
   } catch (const std::exception& e) {
     std::cerr << "Could not retrieve the version of NAOqi: "
@@ -323,10 +376,101 @@ const robot::NaoqiVersion& getNaoqiVersion( const qi::SessionPtr& session )
   return naoqi_version;
 }
 
-const naoqi_bridge_msgs::msg::RobotInfo& getRobotInfo( const qi::SessionPtr& session )
+void prefetchServices( const qi::SessionPtr& session, const std::vector<std::string>& names )
+{
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  SessionCache& cache = cacheFor( session );
+
+  for ( std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it )
+  {
+    if ( cache.services.find( *it ) == cache.services.end() )
+    {
+      ++cache.rpc_count;
+      cache.services[*it] = session->service( *it );
+    }
+  }
+}
+
+std::vector<std::string> joinPrefetchedServices( const qi::SessionPtr& session )
+{
+  std::vector<std::string> missing;
+  std::map<std::string, qi::Future<qi::AnyObject> > services;
+  {
+    boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+    services = cacheFor( session ).services;
+  }
+
+  for ( std::map<std::string, qi::Future<qi::AnyObject> >::iterator it = services.begin();
+        it != services.end(); ++it )
+  {
+    it->second.wait();
+    if ( it->second.hasError() )
+    {
+      missing.push_back( it->first );
+    }
+  }
+  return missing;
+}
+
+qi::AnyObject getService( const qi::SessionPtr& session, const std::string& name )
+{
+  qi::Future<qi::AnyObject> service;
+  {
+    boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+    SessionCache& cache = cacheFor( session );
+    std::map<std::string, qi::Future<qi::AnyObject> >::iterator it = cache.services.find( name );
+    // a failed resolution is tried again, the service may have started since
+    if ( it != cache.services.end() && !( it->second.isFinished() && it->second.hasError() ) )
+    {
+      ++cache.cache_hits;
+      service = it->second;
+    }
+    else
+    {
+      ++cache.rpc_count;
+      service = session->service( name );
+      cache.services[name] = service;
+    }
+  }
+  return service.value();
+}
+
+void invalidateSessionCache()
+{
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  session_cache.url = qi::Url();
+  session_cache.has_version = false;
+  session_cache.has_info = false;
+  session_cache.robot = robot::UNIDENTIFIED;
+  session_cache.services.clear();
+}
+
+size_t getSessionCacheRpcCount()
+{
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  return session_cache.rpc_count;
+}
+
+size_t getSessionCacheHits()
+{
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  return session_cache.cache_hits;
+}
+
+naoqi_bridge_msgs::msg::RobotInfo getRobotInfo( const qi::SessionPtr& session )
 {
-  static naoqi_bridge_msgs::msg::RobotInfo robot_info =  getRobotInfoLocal(session);
-  return robot_info;
+  boost::recursive_mutex::scoped_lock lock( session_cache.mutex );
+  SessionCache& cache = cacheFor( session );
+  if ( cache.has_info )
+  {
+    ++cache.cache_hits;
+  }
+  else
+  {
+    cache.info = getRobotInfoLocal(session);
+    cache.has_info = true;
+  }
+  return cache.info;
 }
 
 /** Function that sets language for a robot
@@ -334,7 +478,7 @@ const naoqi_bridge_msgs::msg::RobotInfo& getRobotInfo( const qi::SessionPtr& ses
 bool setLanguage( const qi::SessionPtr& session, const std::shared_ptr<naoqi_bridge_msgs::srv::SetString::Request> request)
 {
   try{
-    qi::AnyObject dialog = session->service("ALDialog").value();
+    qi::AnyObject dialog = getService( session, "ALDialog" );
     dialog.call<void>("setLanguage", request->data);
     return true;
   }
@@ -347,10 +491,20 @@ bool setLanguage( const qi::SessionPtr& session, const std::shared_ptr<naoqi_bri
  */
 std::string getLanguage( const qi::SessionPtr& session )
 {
-  qi::AnyObject dialog = session->service("ALDialog").value();
+  qi::AnyObject dialog = getService( session, "ALDialog" );
   return dialog.call<std::string>("getLanguage");
 }
 
+bool hasMemoryKey( const qi::SessionPtr& session, const std::string& key )
+{
+  try {
+    getService( session, "ALMemory" ).call<qi::AnyValue>( "getData", key );
+    return true;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
 /**
  * Function that detects if the robot is using stereo cameras to compute depth
  */
@@ -358,7 +512,7 @@ bool isDepthStereo(const qi::SessionPtr &session) {
  std::vector<std::string> sensor_names;
 
  try {
-   qi::AnyObject p_motion = session->service("ALMotion").value();
+   qi::AnyObject p_motion = getService( session, "ALMotion" );
    sensor_names = p_motion.call<std::vector<std::string> >("getSensorNames");
 
    if (std::find(sensor_names.begin(),
@@ -34,11 +34,46 @@ namespace helpers
 namespace driver
 {
 
-const robot::Robot& getRobot( const qi::SessionPtr& session );
+/**
+ * @brief the robot metadata below are returned by value, the cache they
+ * come from is reset by invalidateSessionCache while converters read them
+ */
+robot::Robot getRobot( const qi::SessionPtr& session );
 
-const robot::NaoqiVersion& getNaoqiVersion(const qi::SessionPtr& session);
+/**
+ * @brief request the given services concurrently, getService then returns
+ * them without another round-trip
+ */
+void prefetchServices( const qi::SessionPtr& session, const std::vector<std::string>& names );
 
-const naoqi_bridge_msgs::msg::RobotInfo& getRobotInfo( const qi::SessionPtr& session );
+/**
+ * @brief wait for the prefetched services
+ * @return names of the services that could not be resolved
+ */
+std::vector<std::string> joinPrefetchedServices( const qi::SessionPtr& session );
+
+/**
+ * @brief proxy of a service, resolved once per session and shared,
+ * throws like session->service(name).value() if the service is not available
+ */
+qi::AnyObject getService( const qi::SessionPtr& session, const std::string& name );
+
+/**
+ * @brief forget the robot metadata and the service proxies, so that they
+ * are fetched again, e.g. after the session reconnected
+ */
+void invalidateSessionCache();
+
+/**
+ * @brief round-trips done to fetch robot metadata and service proxies,
+ * and the number of requests served from the cache instead
+ */
+size_t getSessionCacheRpcCount();
+size_t getSessionCacheHits();
+
+robot::NaoqiVersion getNaoqiVersion(const qi::SessionPtr& session);
+
+naoqi_bridge_msgs::msg::RobotInfo getRobotInfo( const qi::SessionPtr& session );
 
 bool setLanguage( const qi::SessionPtr& session, const std::shared_ptr<naoqi_bridge_msgs::srv::SetString::Request> request );
 
@@ -46,6 +81,12 @@ std::string getLanguage( const qi::SessionPtr& session );
 
 bool isDepthStereo(const qi::SessionPtr &session);
 
+/**
+ * @brief check that a memory key can be read, e.g. to keep the sensors
+ * missing on this robot out of a getListData request
+ */
+bool hasMemoryKey( const qi::SessionPtr& session, const std::string& key );
+
 bool isNaoqiVersionLesser(
   const robot::NaoqiVersion& naoqi_version,
   const int& major,
@@ -17,10 +17,85 @@
 
 #include <naoqi_driver/ros_helpers.hpp>
 
+#include <iostream>
+
+#include <boost/make_shared.hpp>
+
 namespace naoqi {
 namespace helpers {
 
 boost::shared_ptr<rclcpp::Node> Node::node_ptr_;
+boost::property_tree::ptree Node::qos_config_;
+boost::mutex Node::watched_mutex_;
+rclcpp::Event::SharedPtr Node::graph_event_;
+std::map<std::string, boost::shared_ptr<std::atomic<size_t> > > Node::watched_topics_;
+
+boost::shared_ptr<const std::atomic<size_t> > Node::watch_subscribers(const std::string& topic_name) {
+  boost::mutex::scoped_lock lock(watched_mutex_);
+  boost::shared_ptr<std::atomic<size_t> >& count = watched_topics_[topic_name];
+  if (!count) {
+    count = boost::make_shared<std::atomic<size_t> >(node_ptr_->count_subscribers(topic_name));
+  }
+  return count;
+}
+
+void Node::refresh_subscribers() {
+  if (!graph_event_ || !graph_event_->check_and_clear()) {
+    return;
+  }
+
+  boost::mutex::scoped_lock lock(watched_mutex_);
+  for (auto& watched: watched_topics_) {
+    watched.second->store(node_ptr_->count_subscribers(watched.first));
+  }
+}
+
+rclcpp::QoS Node::qos(const std::string& topic_name, const rclcpp::QoS& default_qos) {
+  rclcpp::QoS qos = default_qos;
+
+  // topics are matched with or without their leading slash
+  std::string topic = topic_name;
+  if (!topic.empty() && topic[0] == '/') {
+    topic.erase(0, 1);
+  }
+  for (const boost::property_tree::ptree::value_type& entry: qos_config_) {
+    if (entry.first != topic && entry.first != "/" + topic) {
+      continue;
+    }
+    const boost::property_tree::ptree& config = entry.second;
+
+    if (boost::optional<size_t> depth = config.get_optional<size_t>("depth")) {
+      qos.keep_last(*depth);
+    }
+    if (boost::optional<std::string> reliability = config.get_optional<std::string>("reliability")) {
+      if (*reliability == "reliable") {
+        qos.reliable();
+      } else if (*reliability == "best_effort") {
+        qos.best_effort();
+      } else {
+        std::cerr << "Unknown reliability " << *reliability << " for topic " << topic << std::endl;
+      }
+    }
+    if (boost::optional<std::string> durability = config.get_optional<std::string>("durability")) {
+      if (*durability == "volatile") {
+        qos.durability_volatile();
+      } else if (*durability == "transient_local") {
+        qos.transient_local();
+      } else {
+        std::cerr << "Unknown durability " << *durability << " for topic " << topic << std::endl;
+      }
+    }
+    // in seconds
+    if (boost::optional<double> deadline = config.get_optional<double>("deadline")) {
+      qos.deadline(rclcpp::Duration::from_seconds(*deadline));
+    }
+    if (boost::optional<double> lifespan = config.get_optional<double>("lifespan")) {
+      qos.lifespan(rclcpp::Duration::from_seconds(*lifespan));
+    }
+    break;
+  }
+  return qos;
+}
 
 }
 }
\ No newline at end of file
@@ -19,9 +19,14 @@
 #ifndef TRANSFORM_HELPERS_HPP
 #define TRANSFORM_HELPERS_HPP
 
+#include <map>
+#include <string>
+
 #include <geometry_msgs/msg/transform.hpp>
+#include <geometry_msgs/msg/transform_stamped.hpp>
 #include <geometry_msgs/msg/pose.hpp>
 #include <tf2/LinearMath/Matrix3x3.h>
+#include <tf2/LinearMath/Transform.h>
 
 namespace naoqi
 {
@@ -45,6 +50,88 @@ inline double getYaw( const geometry_msgs::msg::Transform& pose)
   return yaw;
 }
 
+inline tf2::Transform toTransform( const geometry_msgs::msg::Transform& msg )
+{
+  return tf2::Transform(
+        tf2::Quaternion(msg.rotation.x, msg.rotation.y, msg.rotation.z, msg.rotation.w),
+        tf2::Vector3(msg.translation.x, msg.translation.y, msg.translation.z) );
+}
+
+inline void toMsg( const tf2::Transform& transform, geometry_msgs::msg::Transform& msg )
+{
+  msg.rotation.x = transform.getRotation().x();
+  msg.rotation.y = transform.getRotation().y();
+  msg.rotation.z = transform.getRotation().z();
+  msg.rotation.w = transform.getRotation().w();
+  msg.translation.x = transform.getOrigin().x();
+  msg.translation.y = transform.getOrigin().y();
+  msg.translation.z = transform.getOrigin().z();
+}
+
+/**
+ * @brief Transforms computed at one instant, indexed by child frame, so that
+ * frames of the same tree can be composed without going through a tf2 buffer
+ */
+class TransformTable
+{
+public:
+  inline void clear()
+  {
+    entries_.clear();
+  }
+
+  inline void add( const geometry_msgs::msg::TransformStamped& msg )
+  {
+    Entry& entry = entries_[msg.child_frame_id];
+    entry.parent = msg.header.frame_id;
+    entry.transform = toTransform( msg.transform );
+  }
+
+  /**
+   * @brief transform of the source frame in the target frame
+   * @return false if both frames are not in the same tree
+   */
+  inline bool lookup( const std::string& target, const std::string& source, tf2::Transform& result ) const
+  {
+    std::string target_root, source_root;
+    tf2::Transform root_to_target, root_to_source;
+    if ( !toRoot( target, root_to_target, target_root ) || !toRoot( source, root_to_source, source_root )
+         || target_root != source_root )
+    {
+      return false;
+    }
+    result = root_to_target.inverse() * root_to_source;
+    return true;
+  }
+
+private:
+  struct Entry
+  {
+    std::string parent;
+    tf2::Transform transform;
+  };
+
+  /** compose the transforms from frame up to the root of its tree */
+  inline bool toRoot( const std::string& frame, tf2::Transform& result, std::string& root ) const
+  {
+    result.setIdentity();
+    root = frame;
+    std::map<std::string, Entry>::const_iterator it;
+    size_t depth = 0;
+    while ( (it = entries_.find( root )) != entries_.end() )
+    {
+      // guard against a loop in the table
+      if ( ++depth > entries_.size() )
+        return false;
+      result = it->second.transform * result;
+      root = it->second.parent;
+    }
+    return true;
+  }
+
+  std::map<std::string, Entry> entries_;
+};
+
 } //transform
 } //helpers
 } // naoqi
@@ -16,14 +16,16 @@
 */
 
 /*
- * BOOST
+ * STANDARD
  */
-#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <sstream>
 
 /*
- * ROS
+ * BOOST
  */
-#include <tf2_ros/buffer.h>
+#include <boost/chrono.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
 /*
  * PUBLIC INTERFACE
@@ -41,8 +43,10 @@
 #include "converters/diagnostics.hpp"
 #include "converters/imu.hpp"
 #include "converters/info.hpp"
+#include "converters/joint_group.hpp"
 #include "converters/joint_state.hpp"
 #include "converters/laser.hpp"
+#include "converters/lazy.hpp"
 #include "converters/memory_list.hpp"
 #include "converters/sonar.hpp"
 #include "converters/memory/bool.hpp"
@@ -51,6 +55,7 @@
 #include "converters/memory/string.hpp"
 #include "converters/log.hpp"
 #include "converters/odom.hpp"
+#include "converters/proprioception.hpp"
 
 /*
  * PUBLISHERS
@@ -58,14 +63,21 @@
 #include "publishers/basic.hpp"
 #include "publishers/camera.hpp"
 #include "publishers/info.hpp"
+#include "publishers/joint_group.hpp"
 #include "publishers/joint_state.hpp"
 #include "publishers/log.hpp"
+#include "publishers/odom.hpp"
+#include "publishers/proprioception.hpp"
 #include "publishers/sonar.hpp"
 
 /*
  * TOOLS
  */
 #include "tools/robot_description.hpp"
+#include "tools/clock_sync.hpp"
+#include "tools/pose_cache.hpp"
+#include "tools/transform_cache.hpp"
+#include "tools/phase_timer.hpp"
 #include "tools/alvisiondefinitions.h" // for kTop...
 
 /*
@@ -91,6 +103,7 @@
 #include "recorder/camera.hpp"
 #include "recorder/diagnostics.hpp"
 #include "recorder/joint_state.hpp"
+#include "recorder/proprioception.hpp"
 #include "recorder/sonar.hpp"
 
 /*
@@ -98,12 +111,17 @@
  */
 #include "event/basic.hpp"
 #include "event/audio.hpp"
+#include "event/imu.hpp"
 #include "event/touch.hpp"
 
 /*
  * ACTIONS
  */
+#include "actions/follow_joint_trajectory.hpp"
 #include "actions/listen.hpp"
+#ifdef WITH_NAV2_MSGS
+#include "actions/navigate_to_pose.hpp"
+#endif
 
 /*
  * STATIC FUNCTIONS INCLUDE
@@ -114,6 +132,10 @@
 #include "helpers/naoqi_helpers.hpp"
 #include "helpers/driver_helpers.hpp"
 
+#if LIBQI_VERSION >= 29
+#include "driver_authenticator.hpp"
+#endif
+
 
 
 namespace ph = boost::placeholders;
@@ -121,14 +143,21 @@ namespace ph = boost::placeholders;
 namespace naoqi
 {
 
-Driver::Driver() : rclcpp::Node("naoqi_driver"),
+Driver::Driver( const rclcpp::NodeOptions& options ) : rclcpp::Node("naoqi_driver", options),
   freq_(15),
   publish_enabled_(false),
   record_enabled_(false),
   log_enabled_(false),
   keep_looping(true),
+  spin_node_(true),
   recorder_(boost::make_shared<recorder::GlobalRecorder>("naoqi_driver")),
-  buffer_duration_(helpers::recorder::bufferDefaultDuration) {}
+  buffer_duration_(helpers::recorder::bufferDefaultDuration),
+  session_lost_(false),
+  reconnect_enabled_(true),
+  reconnect_min_delay_(0.1),
+  reconnect_max_delay_(5.0),
+  lazy_converters_enabled_(false),
+  lazy_idle_timeout_(10.0) {}
 
 Driver::~Driver()
 {
@@ -136,21 +165,66 @@ Driver::~Driver()
     << "naoqi driver is shutting down.."
     << RESETCOLOR
     << std::endl;
+  if ( clock_sync_ )
+  {
+    clock_sync_->stop();
+  }
 }
 
 void Driver::run()
 {
+  init();
+  while ( keep_looping )
+  {
+    spinOnce();
+  }
+}
+
+void Driver::spinOnce()
+{
+  if ( session_lost_ && reconnect_enabled_ )
+  {
+    reconnectSession();
+  }
+  this->rosIteration();
+}
+
+void Driver::init()
+{
+  tools::PhaseTimer timer( "Driver startup" );
   loadBootConfig();
-  auto robot_desc_pub = tools::publishRobotDescription(this, robot_);
+  helpers::Node::setQoSConfig( boot_config_.get_child( "qos", boost::property_tree::ptree() ) );
+  reconnect_enabled_ = boot_config_.get( "session.reconnect", true );
+  reconnect_min_delay_ = boot_config_.get<float>( "session.reconnect_min_delay", 0.1 );
+  reconnect_max_delay_ = boot_config_.get<float>( "session.reconnect_max_delay", 5.0 );
+  timer.mark( "boot config" );
+  robot_description_pub_ = tools::publishRobotDescription(this, robot_);
+  timer.mark( "robot description" );
   registerDefaultConverter();
+  declareConverterParameters();
+  timer.mark( "converters" );
   registerDefaultSubscriber();
+  timer.mark( "subscribers" );
   registerDefaultServices();
+  timer.mark( "services" );
 
   // Setting up action servers.
-  auto listen_server = action::createListenServer(this, sessionPtr_);
+  const std::string listen_policy = boot_config_.get<std::string>( "actions.listen.policy", "reject" );
+  action_servers_.push_back( action::createListenServer(
+    this, sessionPtr_,
+    listen_policy == "queue" ? action::ListenPolicy::Queue :
+    listen_policy == "preempt" ? action::ListenPolicy::Preempt : action::ListenPolicy::Reject,
+    boot_config_.get<size_t>( "actions.listen.queue_size", 4 )) );
+  action_servers_.push_back( action::createFollowJointTrajectoryServer(this, sessionPtr_) );
+#ifdef WITH_NAV2_MSGS
+  action_servers_.push_back( action::createNavigateToPoseServer(this, sessionPtr_, transform_cache_) );
+#endif
+  timer.mark( "actions" );
 
   // A single iteration will propagate registrations, etc...
   rosIteration();
+  timer.mark( "first iteration" );
+  timer.report();
 
   std::cout << BOLDYELLOW
             << "naoqi_driver initialized"
@@ -208,11 +282,86 @@ void Driver::run()
             << RESETCOLOR
             << std::endl;
   std::cout << "Starting ROS loop" << std::endl;
+}
+
+void Driver::onSessionDisconnected( const std::string& reason )
+{
+  std::cout << BOLDRED << "NAOqi session disconnected: " << reason << RESETCOLOR << std::endl;
+  session_lost_ = true;
+}
+
+void Driver::reconnectSession()
+{
+  const boost::chrono::steady_clock::time_point lost_time = boost::chrono::steady_clock::now();
+  std::cout << BOLDYELLOW << "Reconnecting to " << session_url_.str() << RESETCOLOR << std::endl;
 
+  float delay = reconnect_min_delay_;
+  size_t attempts = 0;
   while ( keep_looping )
   {
-    this->rosIteration();
+    ++attempts;
+    // cleared first, so that a drop during the recovery triggers another one
+    session_lost_ = false;
+    qi::Future<void> connecting = sessionPtr_->connect( session_url_ );
+    connecting.wait();
+    if ( !connecting.hasError() )
+    {
+      break;
+    }
+    std::cerr << "Reconnection attempt " << attempts << " failed: " << connecting.error() << std::endl;
+    rclcpp::sleep_for( std::chrono::milliseconds( static_cast<int>( delay * 1000 ) ) );
+    delay = std::min( delay * 2, reconnect_max_delay_ );
+  }
+  if ( !keep_looping )
+  {
+    return;
+  }
+
+  // the converters keep references on the cached robot type and version, fill them again
+  helpers::driver::invalidateSessionCache();
+  robot_ = helpers::driver::getRobot( sessionPtr_ );
+  helpers::driver::getNaoqiVersion( sessionPtr_ );
+
+  if ( pose_cache_ )
+  {
+    pose_cache_->reconnect( sessionPtr_ );
+  }
+  if ( dcm_clock_ )
+  {
+    dcm_clock_->reconnect( sessionPtr_ );
+  }
+
+  {
+    boost::mutex::scoped_lock lock( mutex_conv_queue_ );
+    for( converter::Converter& conv: converters_ )
+    {
+      try {
+        conv.reset();
+      } catch (const std::exception& e) {
+        std::cerr << "Could not reset converter " << conv.name() << " after reconnection: " << e.what() << std::endl;
+      }
+    }
+  }
+  for( subscriber::Subscriber& sub: subscribers_ )
+  {
+    try {
+      sub.reconnect();
+    } catch (const std::exception& e) {
+      std::cerr << "Could not reconnect subscriber " << sub.name() << " after reconnection: " << e.what() << std::endl;
+    }
+  }
+  for( EventIter it = event_map_.begin(); it != event_map_.end(); ++it )
+  {
+    try {
+      it->second.reconnect();
+    } catch (const std::exception& e) {
+      std::cerr << "Could not reconnect event " << it->first << " after reconnection: " << e.what() << std::endl;
+    }
   }
+
+  std::cout << BOLDYELLOW << "NAOqi session recovered in "
+            << boost::chrono::duration<double, boost::milli>( boost::chrono::steady_clock::now() - lost_time ).count()
+            << " ms, after " << attempts << " attempt(s)" << RESETCOLOR << std::endl;
 }
 
 /**
@@ -225,10 +374,67 @@ void Driver::run()
 void Driver::setQiSession(const qi::SessionPtr& session)
 {
   this->sessionPtr_ = session;
+  // metadata and proxies of a previous session are not valid anymore
+  helpers::driver::invalidateSessionCache();
+  session_url_ = session->url();
+  session_lost_ = false;
+  session->disconnected.connect( boost::bind( &Driver::onSessionDisconnected, this, ph::_1 ) );
   robot_ = helpers::driver::getRobot(session);
   has_stereo = helpers::driver::isDepthStereo(session);
 }
 
+bool Driver::connectQiSession(const qi::SessionPtr& session)
+{
+  const std::string no_password = "no_password";
+  std::string protocol = "tcp://";
+
+  // Retrieve the parameters
+  declare_parameter<std::string>("nao_ip", "127.0.0.1");
+  declare_parameter<int>("nao_port", 9559);
+  declare_parameter<std::string>("user", "nao");
+  declare_parameter<std::string>("password", no_password);
+  declare_parameter<std::string>("network_interface", "eth0");
+  declare_parameter<std::string>("qi_listen_url", "tcp://0.0.0.0:0");
+
+  const std::string nao_ip = get_parameter("nao_ip").as_string();
+  int nao_port = get_parameter("nao_port").as_int();
+  const std::string user = get_parameter("user").as_string();
+  const std::string password = get_parameter("password").as_string();
+  const std::string listen_url = get_parameter("qi_listen_url").as_string();
+
+  if (password.compare(no_password) != 0) {
+#if LIBQI_VERSION >= 29
+    protocol = "tcps://";
+    nao_port = (nao_port == 9559) ? 9503 : nao_port;
+
+    DriverAuthenticatorFactory *factory = new DriverAuthenticatorFactory;
+    factory->user = user;
+    factory->pass = password;
+    session->setClientAuthenticatorFactory(
+      qi::ClientAuthenticatorFactoryPtr(factory));
+#else
+    std::cout << BOLDRED
+              << "No need to set a password, ignored."
+              << RESETCOLOR
+              << std::endl;
+#endif
+  }
+
+  qi::Url url(protocol + nao_ip + ":" + std::to_string(nao_port));
+  qi::Future<void> connection = session->connect(url);
+
+  if (connection.hasError()) {
+    std::cout << BOLDRED << connection.error() <<  RESETCOLOR << std::endl;
+    return false;
+  }
+  // The session needs to listen on the network to process audio callbacks.
+  if (!listen_url.empty())
+    session->listen(listen_url);
+
+  setQiSession(session);
+  return true;
+}
+
 void Driver::loadBootConfig()
 {
   const std::string& file_path = helpers::filesystem::getBootConfigFile();
@@ -244,7 +450,16 @@ void Driver::rosIteration() {
 
   {
     boost::mutex::scoped_lock lock( mutex_conv_queue_ );
-    if (!conv_queue_.empty())
+    if (!conv_queue_.empty() && conv_queue_.top().generation_ != conv_generations_[conv_queue_.top().conv_index_])
+    {
+      // rescheduled or disabled through its parameters since this tick was queued
+      conv_queue_.pop();
+    }
+    else if (!conv_queue_.empty() && !spin_node_ && conv_queue_.top().schedule_ > this->now())
+    {
+      // not due yet, the executor calls again instead of blocking on a sleep
+    }
+    else if (!conv_queue_.empty())
     {
       // Wait for the next Publisher to be ready
       size_t conv_index = conv_queue_.top().conv_index_;
@@ -283,7 +498,29 @@ void Driver::rosIteration() {
       // only call when we have at least one action to perform
       if (actions.size() >0)
       {
-        conv.callAll( actions );
+        try {
+          conv.callAll( actions );
+        } catch (const std::exception& e) {
+          // the proxies are dead until the session is reconnected, a call failing on a
+          // closed session triggers the reconnection even before the disconnected signal
+          if ( !session_lost_ && sessionPtr_->isConnected() )
+          {
+            throw;
+          }
+          if ( !session_lost_ )
+          {
+            std::cout << BOLDRED << "NAOqi session lost while calling " << conv.name() << ": " << e.what() << RESETCOLOR << std::endl;
+            session_lost_ = true;
+          }
+        }
+      }
+      else if ( !lazy_converters_.empty() )
+      {
+        std::map< std::string, boost::shared_ptr<converter::LazyConverter> >::iterator lazy_it = lazy_converters_.find( conv.name() );
+        if ( lazy_it != lazy_converters_.end() )
+        {
+          lazy_it->second->releaseIfIdle();
+        }
       }
 
       rclcpp::Duration d(schedule - this->now());
@@ -296,18 +533,18 @@ void Driver::rosIteration() {
       conv_queue_.pop();
       if ( conv.frequency() != 0 )
       {
-        conv_queue_.push(ScheduledConverter(schedule + rclcpp::Duration(0, (1.0f / conv.frequency())*1e9), conv_index));
+        conv_queue_.push(ScheduledConverter(schedule + rclcpp::Duration(0, (1.0f / conv.frequency())*1e9), conv_index, conv_generations_[conv_index]));
       }
 
     }
-    else // conv_queue is empty.
+    else if ( spin_node_ ) // conv_queue is empty.
     {
       // sleep one second
       rclcpp::sleep_for(rclcpp::Duration(1, 0).to_chrono<std::chrono::nanoseconds>());
     }
   } // mutex scope
 
-  if ( publish_enabled_ )
+  if ( publish_enabled_ && spin_node_ )
   {
     rclcpp::spin_some(this->get_node_base_interface());
   }
@@ -480,10 +717,198 @@ void Driver::registerConverter( converter::Converter& conv )
   boost::mutex::scoped_lock lock( mutex_conv_queue_ );
   int conv_index = converters_.size();
   converters_.push_back( conv );
+  conv_generations_.push_back( 0 );
+  conv_enabled_.push_back( true );
   conv.reset();
   conv_queue_.push(ScheduledConverter(this->now(), conv_index));
 }
 
+void Driver::rescheduleConverter( size_t conv_index )
+{
+  ++conv_generations_[conv_index];
+  if ( conv_enabled_[conv_index] && converters_[conv_index].frequency() != 0 )
+  {
+    conv_queue_.push(ScheduledConverter(this->now(), conv_index, conv_generations_[conv_index]));
+  }
+}
+
+/**
+ * Reads a converter frequency, given as a double or as an integer (e.g. frequency:=10)
+ */
+static bool toFrequency( const rclcpp::ParameterValue& value, double& frequency )
+{
+  if ( value.get_type() == rclcpp::ParameterType::PARAMETER_DOUBLE )
+  {
+    frequency = value.get<double>();
+    return true;
+  }
+  if ( value.get_type() == rclcpp::ParameterType::PARAMETER_INTEGER )
+  {
+    frequency = static_cast<double>( value.get<int64_t>() );
+    return true;
+  }
+  return false;
+}
+
+void Driver::declareConverterParameters()
+{
+  // integer frequencies are accepted too instead of failing the declaration
+  rcl_interfaces::msg::ParameterDescriptor frequency_descriptor;
+  frequency_descriptor.dynamic_typing = true;
+
+  // values given at launch differ from the boot config ones, they are applied once declared
+  std::vector<rclcpp::Parameter> overrides;
+  {
+    boost::mutex::scoped_lock lock( mutex_conv_queue_ );
+    for( const converter::Converter& conv: converters_ )
+    {
+      const std::string prefix = "converters." + conv.name() + ".";
+      if ( has_parameter( prefix + "frequency" ) )
+      {
+        continue;
+      }
+      const rclcpp::ParameterValue& frequency = declare_parameter(
+        prefix + "frequency", rclcpp::ParameterValue( static_cast<double>( conv.frequency() ) ), frequency_descriptor );
+      double frequency_value;
+      if ( !toFrequency( frequency, frequency_value ) || frequency_value != conv.frequency() )
+      {
+        overrides.push_back( get_parameter( prefix + "frequency" ) );
+      }
+      if ( !declare_parameter<bool>( prefix + "enabled", true ) )
+      {
+        overrides.push_back( get_parameter( prefix + "enabled" ) );
+      }
+      std::map< std::string, int >::const_iterator res_it = camera_resolutions_.find( conv.name() );
+      if ( res_it != camera_resolutions_.end()
+           && declare_parameter<int>( prefix + "resolution", res_it->second ) != res_it->second )
+      {
+        overrides.push_back( get_parameter( prefix + "resolution" ) );
+      }
+    }
+  }
+
+  if ( !converter_parameters_callback_ )
+  {
+    converter_parameters_callback_ = add_on_set_parameters_callback(
+      [this]( const std::vector<rclcpp::Parameter>& parameters ) { return onConverterParametersSet( parameters ); } );
+  }
+  if ( !overrides.empty() )
+  {
+    const rcl_interfaces::msg::SetParametersResult& result = onConverterParametersSet( overrides );
+    if ( !result.successful )
+    {
+      std::cerr << "Ignoring converter parameters: " << result.reason << std::endl;
+    }
+  }
+}
+
+rcl_interfaces::msg::SetParametersResult Driver::onConverterParametersSet( const std::vector<rclcpp::Parameter>& parameters )
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+
+  boost::mutex::scoped_lock lock( mutex_conv_queue_ );
+
+  // converters.<name>.<field>, checked all before any is applied
+  std::vector< std::pair<size_t, std::string> > targets;
+  for( const rclcpp::Parameter& parameter: parameters )
+  {
+    const std::string& name = parameter.get_name();
+    const size_t first_dot = name.find( '.' );
+    const size_t last_dot = name.rfind( '.' );
+    if ( name.compare( 0, first_dot, "converters" ) != 0 || first_dot == last_dot )
+    {
+      targets.push_back( std::make_pair( converters_.size(), std::string() ) );
+      continue;
+    }
+    const std::string conv_name = name.substr( first_dot + 1, last_dot - first_dot - 1 );
+    const std::string field = name.substr( last_dot + 1 );
+    double frequency;
+
+    size_t conv_index = 0;
+    while ( conv_index < converters_.size() && converters_[conv_index].name() != conv_name )
+    {
+      ++conv_index;
+    }
+    if ( conv_index == converters_.size() )
+    {
+      result.successful = false;
+      result.reason = "no converter named " + conv_name;
+    }
+    else if ( field == "frequency" && ( !toFrequency( parameter.get_parameter_value(), frequency ) || frequency < 0 ) )
+    {
+      result.successful = false;
+      result.reason = "the frequency of " + conv_name + " must be a positive number or 0";
+    }
+    else if ( field == "resolution" && parameter.as_int() < 0 )
+    {
+      result.successful = false;
+      result.reason = "the resolution of " + conv_name + " cannot be negative";
+    }
+    targets.push_back( std::make_pair( conv_index, field ) );
+  }
+  if ( !result.successful )
+  {
+    return result;
+  }
+
+  for( size_t i=0; i<parameters.size(); ++i )
+  {
+    const size_t conv_index = targets[i].first;
+    const std::string& field = targets[i].second;
+    if ( conv_index == converters_.size() )
+    {
+      // not a converter parameter
+      continue;
+    }
+    converter::Converter& conv = converters_[conv_index];
+    boost::shared_ptr<converter::CameraConverter> camera;
+    if ( camera_converters_.count( conv.name() ) )
+    {
+      camera = camera_converters_[conv.name()].lock();
+    }
+
+    double frequency = 0;
+    if ( field == "frequency" )
+    {
+      toFrequency( parameters[i].get_parameter_value(), frequency );
+      conv.setFrequency( frequency );
+      rescheduleConverter( conv_index );
+      // the buffer keeps its duration at the new rate, a stopped converter keeps the previous one
+      std::map<std::string, recorder::Recorder>::iterator rec_it = rec_map_.find( conv.name() );
+      if ( rec_it != rec_map_.end() && frequency > 0 )
+      {
+        rec_it->second.reset( recorder_, frequency );
+      }
+    }
+    else if ( field == "enabled" )
+    {
+      conv_enabled_[conv_index] = parameters[i].as_bool();
+      rescheduleConverter( conv_index );
+    }
+    else if ( field == "resolution" )
+    {
+      camera_resolutions_[conv.name()] = parameters[i].as_int();
+      if ( camera )
+      {
+        camera->setResolution( parameters[i].as_int() );
+      }
+    }
+    else
+    {
+      continue;
+    }
+
+    // the camera is subscribed with its resolution and frame rate, a stopped one keeps its subscription
+    if ( camera && field != "enabled" && !( field == "frequency" && frequency == 0 ) )
+    {
+      camera->reset();
+    }
+    std::cout << "Converter " << conv.name() << ": " << field << " set to " << parameters[i].value_to_string() << std::endl;
+  }
+  return result;
+}
+
 void Driver::registerPublisher( const std::string& conv_name, publisher::Publisher& pub)
 {
   if (publish_enabled_) {
@@ -516,6 +941,21 @@ void Driver::registerConverter( converter::Converter conv, publisher::Publisher
   registerRecorder(  conv.name(), rec, conv.frequency());
 }
 
+void Driver::registerLazyConverter( const std::string& name, float frequency,
+                                    const boost::function<converter::Converter()>& factory,
+                                    publisher::Publisher pub, recorder::Recorder rec )
+{
+  if ( !lazy_converters_enabled_ )
+  {
+    registerConverter( factory(), pub, rec );
+    return;
+  }
+
+  boost::shared_ptr<converter::LazyConverter> lc = boost::make_shared<converter::LazyConverter>( name, frequency, factory, lazy_idle_timeout_ );
+  lazy_converters_[name] = lc;
+  registerConverter( lc, pub, rec );
+}
+
 void Driver::registerPublisher( converter::Converter conv, publisher::Publisher pub )
 {
   registerConverter( conv );
@@ -532,7 +972,7 @@ bool Driver::registerMemoryConverter( const std::string& key, float frequency, c
   dataType::DataType data_type;
   qi::AnyValue value;
   try {
-    qi::AnyObject p_memory = sessionPtr_->service("ALMemory").value();
+    qi::AnyObject p_memory = helpers::driver::getService( sessionPtr_, "ALMemory" );
     value = p_memory.call<qi::AnyValue>("getData", key);
   } catch (const std::exception& e) {
     std::cout << BOLDRED << "Could not get data in memory for the key: "
@@ -592,9 +1032,42 @@ bool Driver::registerMemoryConverter( const std::string& key, float frequency, c
 
 void Driver::registerDefaultConverter()
 {
-  // init global tf2 buffer
-  tf2_buffer_.reset<tf2_ros::Buffer>( new tf2_ros::Buffer(this->get_clock()) );
-  tf2_buffer_->setUsingDedicatedThread(true);
+  tools::PhaseTimer timer( "Converter registration" );
+
+  // resolve the services used by the converters concurrently, they are joined once all are registered
+  static const char* services[] = { "ALMemory", "ALMotion", "ALVideoDevice", "ALRobotModel", "ALAudioDevice",
+                                    "ALBodyTemperature", "ALTextToSpeech", "ALSystem", "LogManager" };
+  helpers::driver::prefetchServices( sessionPtr_, std::vector<std::string>( services, services + sizeof(services)/sizeof(services[0]) ) );
+  timer.mark( "service requests" );
+
+  // init the transforms shared with the subscribers, filled only once one registers a frame pair
+  transform_cache_ = boost::make_shared<tools::TransformCache>();
+
+  // init robot clock synchronization, converters fall back on the reception time until it converges
+  if ( boot_config_.get( "clock_sync.enabled", true) )
+  {
+    float clock_sync_frequency = boot_config_.get<float>( "clock_sync.frequency", 2.0 );
+    clock_sync_ = boost::make_shared<tools::ClockSync>( sessionPtr_, clock_sync_frequency );
+    clock_sync_->start();
+    dcm_clock_ = clock_sync_;
+  }
+  else
+  {
+    // the DCM samples still carry their DCM/Time, map it with a fixed offset rather than the arrival time
+    dcm_clock_ = boost::make_shared<tools::ClockSync>( sessionPtr_ );
+    dcm_clock_->latch();
+  }
+
+  // share the torso pose between converters ticking close to each other, 0 disables the cache
+  float pose_cache_max_age = boot_config_.get<float>( "pose_cache.max_age", 0.02 );
+  if ( pose_cache_max_age > 0 )
+  {
+    pose_cache_ = boost::make_shared<tools::PoseCache>( sessionPtr_, pose_cache_max_age );
+  }
+
+  // build the cameras and diagnostics only once something consumes them
+  lazy_converters_enabled_ = boot_config_.get( "lazy_converters.enabled", false);
+  lazy_idle_timeout_ = boot_config_.get<float>( "lazy_converters.idle_timeout", 10.0 );
 
   // replace this with proper configuration struct
   bool info_enabled                   = boot_config_.get( "converters.info.enabled", true);
@@ -615,6 +1088,9 @@ void Driver::registerDefaultConverter()
   bool imu_base_enabled               = boot_config_.get( "converters.imu_base.enabled", true);
   size_t imu_base_frequency           = boot_config_.get( "converters.imu_base.frequency", 10);
 
+  bool imu_high_rate_enabled          = boot_config_.get( "converters.imu_high_rate.enabled", false);
+  float imu_high_rate_frequency       = boot_config_.get<float>( "converters.imu_high_rate.frequency", 100);
+
   bool camera_front_enabled           = boot_config_.get( "converters.front_camera.enabled", true);
   size_t camera_front_resolution      = boot_config_.get( "converters.front_camera.resolution", 1); // VGA
   size_t camera_front_fps             = boot_config_.get( "converters.front_camera.fps", 10);
@@ -644,6 +1120,10 @@ void Driver::registerDefaultConverter()
 
   bool joint_states_enabled           = boot_config_.get( "converters.joint_states.enabled", true);
   size_t joint_states_frequency       = boot_config_.get( "converters.joint_states.frequency", 50);
+  bool joint_groups_enabled           = boot_config_.get( "converters.joint_states.groups_enabled", false);
+
+  bool proprioception_enabled         = boot_config_.get( "converters.proprioception.enabled", false);
+  size_t proprioception_frequency     = boot_config_.get( "converters.proprioception.frequency", 20);
 
   bool laser_enabled                  = boot_config_.get( "converters.laser.enabled", true);
   size_t laser_frequency              = boot_config_.get( "converters.laser.frequency", 10);
@@ -655,11 +1135,34 @@ void Driver::registerDefaultConverter()
 
   bool odom_enabled                  = boot_config_.get( "converters.odom.enabled", true);
   size_t odom_frequency              = boot_config_.get( "converters.odom.frequency", 10);
+  float odom_prediction_frequency    = boot_config_.get<float>( "converters.odom.prediction_frequency", 0);
+  float odom_correction_time         = boot_config_.get<float>( "converters.odom.correction_time", 0.1);
+  bool odom_publish_tf               = boot_config_.get( "converters.odom.publish_tf", odom_prediction_frequency > odom_frequency);
 
   bool bumper_enabled                 = boot_config_.get( "converters.bumper.enabled", true);
   bool hand_enabled                   = boot_config_.get( "converters.touch_hand.enabled", true);
   bool head_enabled                   = boot_config_.get( "converters.touch_head.enabled", true);
 
+  // The proprioception converter publishes joint states, IMU and odometry
+  // from a single fetch, so the separate converters are not needed
+  if ( proprioception_enabled ) {
+      joint_states_enabled = false;
+      imu_torso_enabled = false;
+      imu_base_enabled = false;
+      odom_enabled = false;
+  }
+
+  // The high rate IMU reads all the inertial units on its own thread
+  if ( imu_high_rate_enabled ) {
+      imu_torso_enabled = false;
+      imu_base_enabled = false;
+  }
+
+  // odom->base_link is broadcast by only one converter
+  if ( !odom_enabled ) {
+      odom_publish_tf = false;
+  }
+
   // Load the correct variables depending on the type of the depth camera
   // (XTION or stereo). IR disabled if the robot uses a stereo camera to
   // compute the depth
@@ -705,21 +1208,25 @@ void Driver::registerDefaultConverter()
   /** DIAGNOSTICS */
   if ( diag_enabled )
   {
-    boost::shared_ptr<converter::DiagnosticsConverter> dc = boost::make_shared<converter::DiagnosticsConverter>( "diag", diag_frequency, sessionPtr_);
     boost::shared_ptr<publisher::BasicPublisher<diagnostic_msgs::msg::DiagnosticArray> > dp = boost::make_shared<publisher::BasicPublisher<diagnostic_msgs::msg::DiagnosticArray> >( "/diagnostics" );
     boost::shared_ptr<recorder::DiagnosticsRecorder>   dr = boost::make_shared<recorder::DiagnosticsRecorder>( "/diagnostics" );
-    dc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::BasicPublisher<diagnostic_msgs::msg::DiagnosticArray>::publish, dp, ph::_1) );
-    dc->registerCallback( message_actions::RECORD, boost::bind(&recorder::DiagnosticsRecorder::write, dr, ph::_1) );
-    dc->registerCallback( message_actions::LOG, boost::bind(&recorder::DiagnosticsRecorder::bufferize, dr, ph::_1) );
-    registerConverter( dc, dp, dr );
+    registerLazyConverter( "diag", diag_frequency, [this, diag_frequency, dp, dr]()
+    {
+      boost::shared_ptr<converter::DiagnosticsConverter> dc = boost::make_shared<converter::DiagnosticsConverter>( "diag", diag_frequency, sessionPtr_);
+      dc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::BasicPublisher<diagnostic_msgs::msg::DiagnosticArray>::publish, dp, ph::_1) );
+      dc->registerCallback( message_actions::RECORD, boost::bind(&recorder::DiagnosticsRecorder::write, dr, ph::_1) );
+      dc->registerCallback( message_actions::LOG, boost::bind(&recorder::DiagnosticsRecorder::bufferize, dr, ph::_1) );
+      return converter::Converter( dc );
+    }, dp, dr );
   }
 
   /** IMU TORSO **/
   if ( imu_torso_enabled )
   {
-    boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::Imu> > imutp = boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::Imu> >( "imu/torso" );
+    boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::Imu> > imutp = boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::Imu> >( "imu/torso", rclcpp::SensorDataQoS() );
     boost::shared_ptr<recorder::BasicRecorder<sensor_msgs::msg::Imu> > imutr = boost::make_shared<recorder::BasicRecorder<sensor_msgs::msg::Imu> >( "imu/torso" );
     boost::shared_ptr<converter::ImuConverter> imutc = boost::make_shared<converter::ImuConverter>( "imu_torso", converter::IMU::TORSO, imu_torso_frequency, sessionPtr_);
+    imutc->setClockSync( dcm_clock_ );
     imutc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::BasicPublisher<sensor_msgs::msg::Imu>::publish, imutp, ph::_1) );
     imutc->registerCallback( message_actions::RECORD, boost::bind(&recorder::BasicRecorder<sensor_msgs::msg::Imu>::write, imutr, ph::_1) );
     imutc->registerCallback( message_actions::LOG, boost::bind(&recorder::BasicRecorder<sensor_msgs::msg::Imu>::bufferize, imutr, ph::_1) );
@@ -731,9 +1238,10 @@ void Driver::registerDefaultConverter()
     /** IMU BASE **/
     if ( imu_base_enabled )
     {
-      boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::Imu> > imubp = boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::Imu> >( "imu/base" );
+      boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::Imu> > imubp = boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::Imu> >( "imu/base", rclcpp::SensorDataQoS() );
       boost::shared_ptr<recorder::BasicRecorder<sensor_msgs::msg::Imu> > imubr = boost::make_shared<recorder::BasicRecorder<sensor_msgs::msg::Imu> >( "imu/base" );
       boost::shared_ptr<converter::ImuConverter> imubc = boost::make_shared<converter::ImuConverter>( "imu_base", converter::IMU::BASE, imu_base_frequency, sessionPtr_);
+      imubc->setClockSync( dcm_clock_ );
       imubc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::BasicPublisher<sensor_msgs::msg::Imu>::publish, imubp, ph::_1) );
       imubc->registerCallback( message_actions::RECORD, boost::bind(&recorder::BasicRecorder<sensor_msgs::msg::Imu>::write, imubr, ph::_1) );
       imubc->registerCallback( message_actions::LOG, boost::bind(&recorder::BasicRecorder<sensor_msgs::msg::Imu>::bufferize, imubr, ph::_1) );
@@ -746,11 +1254,17 @@ void Driver::registerDefaultConverter()
   {
     boost::shared_ptr<publisher::CameraPublisher> fcp = boost::make_shared<publisher::CameraPublisher>( "camera/front/image_raw", AL::kTopCamera );
     boost::shared_ptr<recorder::CameraRecorder> fcr = boost::make_shared<recorder::CameraRecorder>( "camera/front", camera_front_recorder_fps );
-    boost::shared_ptr<converter::CameraConverter> fcc = boost::make_shared<converter::CameraConverter>( "front_camera", camera_front_fps, sessionPtr_, AL::kTopCamera, camera_front_resolution );
-    fcc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, fcp, ph::_1, ph::_2) );
-    fcc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, fcr, ph::_1, ph::_2) );
-    fcc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, fcr, ph::_1, ph::_2) );
-    registerConverter( fcc, fcp, fcr );
+    camera_resolutions_["front_camera"] = camera_front_resolution;
+    registerLazyConverter( "front_camera", camera_front_fps, [this, camera_front_fps, fcp, fcr]()
+    {
+      boost::shared_ptr<converter::CameraConverter> fcc = boost::make_shared<converter::CameraConverter>( "front_camera", camera_front_fps, sessionPtr_, AL::kTopCamera, camera_resolutions_["front_camera"] );
+      fcc->setClockSync( clock_sync_ );
+      fcc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, fcp, ph::_1, ph::_2) );
+      fcc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, fcr, ph::_1, ph::_2) );
+      fcc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, fcr, ph::_1, ph::_2) );
+      camera_converters_["front_camera"] = fcc;
+      return converter::Converter( fcc );
+    }, fcp, fcr );
   }
 
   /** Front Camera */
@@ -758,11 +1272,17 @@ void Driver::registerDefaultConverter()
   {
     boost::shared_ptr<publisher::CameraPublisher> bcp = boost::make_shared<publisher::CameraPublisher>( "camera/bottom/image_raw", AL::kBottomCamera );
     boost::shared_ptr<recorder::CameraRecorder> bcr = boost::make_shared<recorder::CameraRecorder>( "camera/bottom", camera_bottom_recorder_fps );
-    boost::shared_ptr<converter::CameraConverter> bcc = boost::make_shared<converter::CameraConverter>( "bottom_camera", camera_bottom_fps, sessionPtr_, AL::kBottomCamera, camera_bottom_resolution );
-    bcc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, bcp, ph::_1, ph::_2) );
-    bcc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, bcr, ph::_1, ph::_2) );
-    bcc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, bcr, ph::_1, ph::_2) );
-    registerConverter( bcc, bcp, bcr );
+    camera_resolutions_["bottom_camera"] = camera_bottom_resolution;
+    registerLazyConverter( "bottom_camera", camera_bottom_fps, [this, camera_bottom_fps, bcp, bcr]()
+    {
+      boost::shared_ptr<converter::CameraConverter> bcc = boost::make_shared<converter::CameraConverter>( "bottom_camera", camera_bottom_fps, sessionPtr_, AL::kBottomCamera, camera_resolutions_["bottom_camera"] );
+      bcc->setClockSync( clock_sync_ );
+      bcc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, bcp, ph::_1, ph::_2) );
+      bcc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, bcr, ph::_1, ph::_2) );
+      bcc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, bcr, ph::_1, ph::_2) );
+      camera_converters_["bottom_camera"] = bcc;
+      return converter::Converter( bcc );
+    }, bcp, bcr );
   }
 
 
@@ -773,18 +1293,24 @@ void Driver::registerDefaultConverter()
     {
       boost::shared_ptr<publisher::CameraPublisher> dcp = boost::make_shared<publisher::CameraPublisher>( "camera/depth/image_raw", AL::kDepthCamera );
       boost::shared_ptr<recorder::CameraRecorder> dcr = boost::make_shared<recorder::CameraRecorder>( "camera/depth", camera_depth_recorder_fps );
-      boost::shared_ptr<converter::CameraConverter> dcc = boost::make_shared<converter::CameraConverter>(
-        "depth_camera",
-        camera_depth_fps,
-        sessionPtr_,
-        AL::kDepthCamera,
-        camera_depth_resolution,
-        this->has_stereo);
-
-      dcc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, dcp, ph::_1, ph::_2) );
-      dcc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, dcr, ph::_1, ph::_2) );
-      dcc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, dcr, ph::_1, ph::_2) );
-      registerConverter( dcc, dcp, dcr );
+      camera_resolutions_["depth_camera"] = camera_depth_resolution;
+      registerLazyConverter( "depth_camera", camera_depth_fps, [this, camera_depth_fps, dcp, dcr]()
+      {
+        boost::shared_ptr<converter::CameraConverter> dcc = boost::make_shared<converter::CameraConverter>(
+          "depth_camera",
+          camera_depth_fps,
+          sessionPtr_,
+          AL::kDepthCamera,
+          camera_resolutions_["depth_camera"],
+          this->has_stereo);
+
+        dcc->setClockSync( clock_sync_ );
+        dcc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, dcp, ph::_1, ph::_2) );
+        dcc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, dcr, ph::_1, ph::_2) );
+        dcc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, dcr, ph::_1, ph::_2) );
+        camera_converters_["depth_camera"] = dcc;
+        return converter::Converter( dcc );
+      }, dcp, dcr );
     }
 
     /** Stereo Camera */
@@ -793,18 +1319,24 @@ void Driver::registerDefaultConverter()
       boost::shared_ptr<publisher::CameraPublisher> scp = boost::make_shared<publisher::CameraPublisher>( "camera/stereo/image_raw", AL::kInfraredOrStereoCamera );
       boost::shared_ptr<recorder::CameraRecorder> scr = boost::make_shared<recorder::CameraRecorder>( "camera/stereo", camera_stereo_recorder_fps );
 
-      boost::shared_ptr<converter::CameraConverter> scc = boost::make_shared<converter::CameraConverter>(
-        "stereo_camera",
-        camera_stereo_fps,
-        sessionPtr_,
-        AL::kInfraredOrStereoCamera,
-        camera_stereo_resolution,
-        this->has_stereo);
-
-      scc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, scp, ph::_1, ph::_2) );
-      scc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, scr, ph::_1, ph::_2) );
-      scc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, scr, ph::_1, ph::_2) );
-      registerConverter( scc, scp, scr );
+      camera_resolutions_["stereo_camera"] = camera_stereo_resolution;
+      registerLazyConverter( "stereo_camera", camera_stereo_fps, [this, camera_stereo_fps, scp, scr]()
+      {
+        boost::shared_ptr<converter::CameraConverter> scc = boost::make_shared<converter::CameraConverter>(
+          "stereo_camera",
+          camera_stereo_fps,
+          sessionPtr_,
+          AL::kInfraredOrStereoCamera,
+          camera_resolutions_["stereo_camera"],
+          this->has_stereo);
+
+        scc->setClockSync( clock_sync_ );
+        scc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, scp, ph::_1, ph::_2) );
+        scc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, scr, ph::_1, ph::_2) );
+        scc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, scr, ph::_1, ph::_2) );
+        camera_converters_["stereo_camera"] = scc;
+        return converter::Converter( scc );
+      }, scp, scr );
     }
 
     /** Infrared Camera */
@@ -812,11 +1344,17 @@ void Driver::registerDefaultConverter()
     {
       boost::shared_ptr<publisher::CameraPublisher> icp = boost::make_shared<publisher::CameraPublisher>( "camera/ir/image_raw", AL::kInfraredOrStereoCamera );
       boost::shared_ptr<recorder::CameraRecorder> icr = boost::make_shared<recorder::CameraRecorder>( "camera/ir", camera_ir_recorder_fps );
-      boost::shared_ptr<converter::CameraConverter> icc = boost::make_shared<converter::CameraConverter>( "infrared_camera", camera_ir_fps, sessionPtr_, AL::kInfraredOrStereoCamera, camera_ir_resolution);
-      icc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, icp, ph::_1, ph::_2) );
-      icc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, icr, ph::_1, ph::_2) );
-      icc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, icr, ph::_1, ph::_2) );
-      registerConverter( icc, icp, icr );
+      camera_resolutions_["infrared_camera"] = camera_ir_resolution;
+      registerLazyConverter( "infrared_camera", camera_ir_fps, [this, camera_ir_fps, icp, icr]()
+      {
+        boost::shared_ptr<converter::CameraConverter> icc = boost::make_shared<converter::CameraConverter>( "infrared_camera", camera_ir_fps, sessionPtr_, AL::kInfraredOrStereoCamera, camera_resolutions_["infrared_camera"]);
+        icc->setClockSync( clock_sync_ );
+        icc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::CameraPublisher::publish, icp, ph::_1, ph::_2) );
+        icc->registerCallback( message_actions::RECORD, boost::bind(&recorder::CameraRecorder::write, icr, ph::_1, ph::_2) );
+        icc->registerCallback( message_actions::LOG, boost::bind(&recorder::CameraRecorder::bufferize, icr, ph::_1, ph::_2) );
+        camera_converters_["infrared_camera"] = icc;
+        return converter::Converter( icc );
+      }, icp, icr );
     }
   } // endif PEPPER
 
@@ -825,7 +1363,9 @@ void Driver::registerDefaultConverter()
   {
     boost::shared_ptr<publisher::JointStatePublisher> jsp = boost::make_shared<publisher::JointStatePublisher>( "/joint_states" );
     boost::shared_ptr<recorder::JointStateRecorder> jsr = boost::make_shared<recorder::JointStateRecorder>( "/joint_states" );
-    boost::shared_ptr<converter::JointStateConverter> jsc = boost::make_shared<converter::JointStateConverter>( "joint_states", joint_states_frequency, tf2_buffer_, sessionPtr_ );
+    boost::shared_ptr<converter::JointStateConverter> jsc = boost::make_shared<converter::JointStateConverter>( "joint_states", joint_states_frequency, transform_cache_, sessionPtr_ );
+    jsc->setPoseCache( pose_cache_ );
+    jsc->setPublishOdomTransform( !odom_publish_tf );
     jsc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::JointStatePublisher::publish, jsp, ph::_1, ph::_2) );
     jsc->registerCallback( message_actions::RECORD, boost::bind(&recorder::JointStateRecorder::write, jsr, ph::_1, ph::_2) );
     jsc->registerCallback( message_actions::LOG, boost::bind(&recorder::JointStateRecorder::bufferize, jsr, ph::_1, ph::_2) );
@@ -833,12 +1373,68 @@ void Driver::registerDefaultConverter()
     //  registerRecorder(jsc, jsr);
   }
 
+  /** Joint groups, each read at its own rate on joint_states/<group> */
+  if ( joint_groups_enabled )
+  {
+    boost::optional<boost::property_tree::ptree&> groups = boot_config_.get_child_optional( "converters.joint_states.groups" );
+    if ( groups )
+    {
+      for( boost::property_tree::ptree::value_type& group: *groups )
+      {
+        // space separated chain or joint names
+        std::vector<std::string> body_names;
+        std::istringstream names( group.second.get<std::string>( "names", "" ) );
+        for( std::string body_name; names >> body_name; )
+        {
+          body_names.push_back( body_name );
+        }
+        float group_frequency = group.second.get<float>( "frequency", joint_states_frequency );
+
+        const std::string topic = "joint_states/" + group.first;
+        boost::shared_ptr<publisher::JointGroupPublisher> jgp = boost::make_shared<publisher::JointGroupPublisher>( topic );
+        boost::shared_ptr<recorder::BasicRecorder<sensor_msgs::msg::JointState> > jgr = boost::make_shared<recorder::BasicRecorder<sensor_msgs::msg::JointState> >( topic );
+        boost::shared_ptr<converter::JointGroupConverter> jgc = boost::make_shared<converter::JointGroupConverter>( "joint_states_" + group.first, group_frequency, body_names, sessionPtr_ );
+        jgc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::JointGroupPublisher::publish, jgp, ph::_1) );
+        jgc->registerCallback( message_actions::RECORD, boost::bind(&recorder::BasicRecorder<sensor_msgs::msg::JointState>::write, jgr, ph::_1) );
+        jgc->registerCallback( message_actions::LOG, boost::bind(&recorder::BasicRecorder<sensor_msgs::msg::JointState>::bufferize, jgr, ph::_1) );
+        registerConverter( jgc, jgp, jgr );
+      }
+    }
+  }
+
+  /** Proprioception */
+  if ( proprioception_enabled )
+  {
+    std::vector<std::string> imu_topics;
+    std::vector<converter::IMU::Location> imu_locations;
+    if ( !imu_high_rate_enabled )
+    {
+      imu_topics.push_back( "imu/torso" );
+      imu_locations.push_back( converter::IMU::TORSO );
+      if ( robot_ == robot::PEPPER )
+      {
+        imu_topics.push_back( "imu/base" );
+        imu_locations.push_back( converter::IMU::BASE );
+      }
+    }
+    boost::shared_ptr<publisher::ProprioceptionPublisher> pp = boost::make_shared<publisher::ProprioceptionPublisher>( "/joint_states", imu_topics, "odom" );
+    boost::shared_ptr<recorder::ProprioceptionRecorder> pr = boost::make_shared<recorder::ProprioceptionRecorder>( "/joint_states", imu_topics, "odom" );
+    boost::shared_ptr<converter::ProprioceptionConverter> pc = boost::make_shared<converter::ProprioceptionConverter>( "proprioception", proprioception_frequency, transform_cache_, sessionPtr_ );
+    pc->setClockSync( dcm_clock_ );
+    pc->setPoseCache( pose_cache_ );
+    pc->setImuLocations( imu_locations );
+    pc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::ProprioceptionPublisher::publish, pp, ph::_1, ph::_2, ph::_3, ph::_4) );
+    pc->registerCallback( message_actions::RECORD, boost::bind(&recorder::ProprioceptionRecorder::write, pr, ph::_1, ph::_2, ph::_3, ph::_4) );
+    pc->registerCallback( message_actions::LOG, boost::bind(&recorder::ProprioceptionRecorder::bufferize, pr, ph::_1, ph::_2, ph::_3, ph::_4) );
+    registerConverter( pc, pp, pr );
+  }
+
   if(robot_ == robot::PEPPER)
   {
     /** Laser */
     if ( laser_enabled )
     {
-      boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::LaserScan> > lp = boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::LaserScan> >( "laser" );
+      boost::shared_ptr<publisher::BasicPublisher<sensor_msgs::msg::LaserScan> > lp = boost::make_shared<publisher::BasicPublisher<sensor_msgs::msg::LaserScan> >( "laser", rclcpp::SensorDataQoS() );
       boost::shared_ptr<recorder::BasicRecorder<sensor_msgs::msg::LaserScan> > lr = boost::make_shared<recorder::BasicRecorder<sensor_msgs::msg::LaserScan> >( "laser" );
       boost::shared_ptr<converter::LaserConverter> lc = boost::make_shared<converter::LaserConverter>( "laser", laser_frequency, sessionPtr_ );
 
@@ -873,9 +1469,32 @@ void Driver::registerDefaultConverter()
     registerConverter( usc, usp, usr );
   }
 
+  if ( imu_high_rate_enabled ) {
+    /** High rate IMU */
+    std::vector<std::string> imu_topics;
+    std::vector<converter::IMU::Location> imu_locations;
+    imu_topics.push_back( "imu/torso" );
+    imu_locations.push_back( converter::IMU::TORSO );
+    if ( robot_ == robot::PEPPER )
+    {
+      imu_topics.push_back( "imu/base" );
+      imu_locations.push_back( converter::IMU::BASE );
+    }
+    auto event_register = boost::make_shared<ImuEventRegister>( imu_locations, imu_topics, imu_high_rate_frequency, sessionPtr_ );
+    event_register->setClockSync( dcm_clock_ );
+    insertEventConverter("imu", event_register);
+    if (keep_looping) {
+      event_map_.find("imu")->second.startProcess();
+    }
+    if (publish_enabled_) {
+      event_map_.find("imu")->second.isPublishing(true);
+    }
+  }
+
   if ( audio_enabled ) {
     /** Audio */
     auto event_register = boost::make_shared<AudioEventRegister>("audio", 0, sessionPtr_);
+    event_register->setClockSync( clock_sync_ );
     insertEventConverter("audio", event_register);
     if (keep_looping) {
       try
@@ -955,15 +1574,34 @@ void Driver::registerDefaultConverter()
   /** Odom */
   if ( odom_enabled )
   {
-    boost::shared_ptr<publisher::BasicPublisher<nav_msgs::msg::Odometry> > lp = boost::make_shared<publisher::BasicPublisher<nav_msgs::msg::Odometry> >( "odom" );
+    // with prediction, the converter runs at the prediction rate and polls NAOqi at odom_frequency
+    bool odom_prediction = odom_prediction_frequency > odom_frequency;
+    boost::shared_ptr<publisher::OdomPublisher> lp = boost::make_shared<publisher::OdomPublisher>( "odom", odom_publish_tf );
     boost::shared_ptr<recorder::BasicRecorder<nav_msgs::msg::Odometry> > lr = boost::make_shared<recorder::BasicRecorder<nav_msgs::msg::Odometry> >( "odom" );
-    boost::shared_ptr<converter::OdomConverter> lc = boost::make_shared<converter::OdomConverter>( "odom", odom_frequency, sessionPtr_ );
-    lc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::BasicPublisher<nav_msgs::msg::Odometry>::publish, lp, ph::_1) );
+    boost::shared_ptr<converter::OdomConverter> lc = boost::make_shared<converter::OdomConverter>( "odom", odom_prediction ? odom_prediction_frequency : odom_frequency, sessionPtr_ );
+    lc->setPoseCache( pose_cache_ );
+    if ( odom_prediction )
+    {
+      lc->setPrediction( odom_frequency, odom_correction_time );
+    }
+    lc->registerCallback( message_actions::PUBLISH, boost::bind(&publisher::OdomPublisher::publish, lp, ph::_1) );
     lc->registerCallback( message_actions::RECORD, boost::bind(&recorder::BasicRecorder<nav_msgs::msg::Odometry>::write, lr, ph::_1) );
     lc->registerCallback( message_actions::LOG, boost::bind(&recorder::BasicRecorder<nav_msgs::msg::Odometry>::bufferize, lr, ph::_1) );
     registerConverter( lc, lp, lr );
   }
+  timer.mark( "converters" );
+
+  const std::vector<std::string>& missing_services = helpers::driver::joinPrefetchedServices( sessionPtr_ );
+  for ( std::vector<std::string>::const_iterator it = missing_services.begin(); it != missing_services.end(); ++it )
+  {
+    std::cout << "Service " << *it << " is not available on this robot" << std::endl;
+  }
+  timer.mark( "service join" );
+  timer.report();
 
+  const size_t metadata_rpcs = helpers::driver::getSessionCacheRpcCount();
+  std::cout << "Robot metadata and service proxies: " << metadata_rpcs << " round-trips, "
+            << metadata_rpcs + helpers::driver::getSessionCacheHits() << " without the session cache" << std::endl;
 }
 
 
@@ -993,8 +1631,11 @@ void Driver::registerDefaultSubscriber()
 {
   if (!subscribers_.empty())
     return;
-  registerSubscriber( boost::make_shared<naoqi::subscriber::TeleopSubscriber>("teleop", "/cmd_vel", "/joint_angles", sessionPtr_) );
-  registerSubscriber( boost::make_shared<naoqi::subscriber::MovetoSubscriber>("moveto", "/goal_pose", sessionPtr_, tf2_buffer_) );
+  boost::shared_ptr<naoqi::subscriber::TeleopSubscriber> teleop = boost::make_shared<naoqi::subscriber::TeleopSubscriber>("teleop", "/cmd_vel", "/joint_angles", sessionPtr_);
+  teleop->setControl( boot_config_.get<float>( "subscribers.teleop.control_rate", 20 ),
+                      boot_config_.get<float>( "subscribers.teleop.cmd_vel_timeout", 0.5 ) );
+  registerSubscriber( teleop );
+  registerSubscriber( boost::make_shared<naoqi::subscriber::MovetoSubscriber>("moveto", "/goal_pose", sessionPtr_, transform_cache_) );
   registerSubscriber( boost::make_shared<naoqi::subscriber::SpeechSubscriber>("speech", "/speech", sessionPtr_) );
 }
 
@@ -1177,9 +1818,19 @@ void Driver::stop()
   }
 
   converters_.clear();
+  conv_generations_.clear();
+  conv_enabled_.clear();
   subscribers_.clear();
   event_map_.clear();
-  rclcpp::spin_some(this->get_node_base_interface());
+  if ( spin_node_ )
+  {
+    rclcpp::spin_some(this->get_node_base_interface());
+  }
+}
+
+void Driver::disableSpinning()
+{
+  spin_node_ = false;
 }
 
 void Driver::parseJsonFile(std::string filepath, boost::property_tree::ptree &pt){
@@ -1256,7 +1907,7 @@ bool Driver::registerEventConverter(const std::string& key, const dataType::Data
   dataType::DataType data_type;
   qi::AnyValue value;
   try {
-    qi::AnyObject p_memory = sessionPtr_->service("ALMemory").value();
+    qi::AnyObject p_memory = helpers::driver::getService( sessionPtr_, "ALMemory" );
     value = p_memory.call<qi::AnyValue>("getData", key);
   } catch (const std::exception& e) {
     std::cout << BOLDRED << "Could not get data in memory for the key: "
@@ -36,9 +36,10 @@ class BasicPublisher
 {
 
 public:
-  BasicPublisher( const std::string& topic ):
+  BasicPublisher( const std::string& topic, const rclcpp::QoS& qos = rclcpp::QoS(10) ):
     topic_( topic ),
-    is_initialized_( false )
+    is_initialized_( false ),
+    qos_( qos )
   {}
 
   virtual ~BasicPublisher() {}
@@ -58,18 +59,21 @@ public:
     if (is_initialized_ == false) {
       return false;
     } else {
-      return helpers::Node::count_subscribers(topic_) > 0;
+      helpers::Node::refresh_subscribers();
+      return *subscribers_ > 0;
     }
   }
 
   virtual void publish( const T& msg )
   {
-    pub_->publish( msg );
+    helpers::publishCopy( *pub_, msg );
   }
 
   virtual void reset( rclcpp::Node* node )
   {
-    pub_ = node->create_publisher<T>( this->topic_, 10 );
+    const rclcpp::QoS& qos = helpers::Node::qos( this->topic_, qos_ );
+    pub_ = node->create_publisher<T>( this->topic_, qos, helpers::Node::publisher_options( qos ) );
+    subscribers_ = helpers::Node::watch_subscribers( this->topic_ );
     is_initialized_ = true;
   }
 
@@ -78,8 +82,13 @@ protected:
 
   bool is_initialized_;
 
+  /** QoS of the topic unless set in the boot config */
+  rclcpp::QoS qos_;
+
   /** Publisher */
   typename rclcpp::Publisher<T>::SharedPtr pub_;
+  /** Subscribers of the topic, updated on graph changes */
+  boost::shared_ptr<const std::atomic<size_t> > subscribers_;
 }; // class
 
 } // publisher
@@ -43,14 +43,18 @@ CameraPublisher::~CameraPublisher()
 
 void CameraPublisher::publish( const sensor_msgs::msg::Image::SharedPtr& img, const sensor_msgs::msg::CameraInfo& camera_info )
 {
-  pub_.publish( *img, camera_info );
+  // the image is shared with the intra-process subscriptions instead of copied,
+  // the converter fills a new one for each frame
+  pub_.publish( img, std::make_shared<sensor_msgs::msg::CameraInfo>( camera_info ) );
 }
 
 void CameraPublisher::reset( rclcpp::Node* node )
 {
-  pub_ = image_transport::create_camera_publisher(node, topic_);
+  pub_ = image_transport::create_camera_publisher(node, topic_,
+    helpers::Node::qos(topic_, rclcpp::SensorDataQoS()).get_rmw_qos_profile());
+  subscribers_ = helpers::Node::watch_subscribers(topic_);
   /* TODO */
-  /* Specify the QoS or remove unwanted image_transports topics by disabling plugin
+  /* Remove unwanted image_transports topics by disabling plugin
   in the lanchfile. */
 
   // Unregister compressedDepth topics for non depth cameras
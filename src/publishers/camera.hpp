@@ -59,7 +59,8 @@ public:
     if (is_initialized_ == false){
       return false;
     } else{
-      return helpers::Node::count_subscribers(topic_) > 0;
+      helpers::Node::refresh_subscribers();
+      return *subscribers_ > 0;
     }
   }
 
@@ -70,6 +71,8 @@ private:
 
   //image_transport::ImageTransport it_;
   image_transport::CameraPublisher pub_;
+  /** Subscribers of the image topic, updated on graph changes */
+  boost::shared_ptr<const std::atomic<size_t> > subscribers_;
 
   int camera_source_;
 };
@@ -36,7 +36,8 @@ namespace publisher
 class InfoPublisher : public BasicPublisher<naoqi_bridge_msgs::msg::StringStamped>
 {
 public:
-  InfoPublisher(const std::string& topic) : BasicPublisher(topic)
+  // latched, like the robot description
+  InfoPublisher(const std::string& topic) : BasicPublisher(topic, rclcpp::QoS(1).transient_local())
   {
   }
 
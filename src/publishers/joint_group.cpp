@@ -0,0 +1,53 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "joint_group.hpp"
+
+namespace naoqi
+{
+namespace publisher
+{
+
+JointGroupPublisher::JointGroupPublisher( const std::string& topic ):
+  group_pub_( topic ),
+  is_initialized_( false )
+{
+}
+
+void JointGroupPublisher::publish( const sensor_msgs::msg::JointState& js_msg )
+{
+  if ( group_pub_.isSubscribed() )
+    group_pub_.publish( js_msg );
+}
+
+void JointGroupPublisher::reset( rclcpp::Node* node )
+{
+  group_pub_.reset( node );
+
+  is_initialized_ = true;
+}
+
+bool JointGroupPublisher::isSubscribed() const
+{
+  return group_pub_.isSubscribed();
+}
+
+} //publisher
+} // naoqi
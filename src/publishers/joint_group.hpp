@@ -0,0 +1,72 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef JOINT_GROUP_PUBLISHER_HPP
+#define JOINT_GROUP_PUBLISHER_HPP
+
+/*
+* LOCAL includes
+*/
+#include "basic.hpp"
+
+/*
+* ROS includes
+*/
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/joint_state.hpp>
+
+namespace naoqi
+{
+namespace publisher
+{
+
+/**
+ * @brief Publish the joint states of a group on its own topic, the full
+ * joint states stay on /joint_states so that partial messages are not mixed in
+ */
+class JointGroupPublisher
+{
+public:
+  JointGroupPublisher( const std::string& topic );
+
+  inline std::string topic() const
+  {
+    return group_pub_.topic();
+  }
+
+  inline bool isInitialized() const
+  {
+    return is_initialized_;
+  }
+
+  void publish( const sensor_msgs::msg::JointState& js_msg );
+
+  void reset( rclcpp::Node* node );
+
+  bool isSubscribed() const;
+
+private:
+  BasicPublisher<sensor_msgs::msg::JointState> group_pub_;
+
+  bool is_initialized_;
+
+}; // class
+
+} //publisher
+} // naoqi
+
+#endif
@@ -33,7 +33,7 @@ JointStatePublisher::JointStatePublisher( const std::string& topic ):
 void JointStatePublisher::publish( const sensor_msgs::msg::JointState& js_msg,
                                    const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms )
 {
-  pub_joint_states_->publish( js_msg );
+  helpers::publishCopy( *pub_joint_states_, js_msg );
 
   /**
    * ROBOT STATE PUBLISHER
@@ -43,7 +43,8 @@ void JointStatePublisher::publish( const sensor_msgs::msg::JointState& js_msg,
 
 void JointStatePublisher::reset( rclcpp::Node* node )
 {
-  pub_joint_states_ = node->create_publisher<sensor_msgs::msg::JointState>( topic_, 10 );
+  const rclcpp::QoS& qos = helpers::Node::qos( topic_, rclcpp::QoS(10) );
+  pub_joint_states_ = node->create_publisher<sensor_msgs::msg::JointState>( topic_, qos, helpers::Node::publisher_options( qos ) );
 
   tf_broadcasterPtr_ = boost::make_shared<tf2_ros::TransformBroadcaster>(node);
 
@@ -25,6 +25,7 @@
 #include <geometry_msgs/msg/transform.hpp>
 #include <sensor_msgs/msg/joint_state.hpp>
 #include <tf2_ros/transform_broadcaster.h>
+#include <naoqi_driver/ros_helpers.hpp>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "odom.hpp"
+
+#include <boost/make_shared.hpp>
+
+namespace naoqi
+{
+namespace publisher
+{
+
+OdomPublisher::OdomPublisher( const std::string& topic, bool publish_tf ):
+  BasicPublisher<nav_msgs::msg::Odometry>( topic ),
+  publish_tf_( publish_tf )
+{}
+
+void OdomPublisher::publish( const nav_msgs::msg::Odometry& odom_msg )
+{
+  if ( BasicPublisher<nav_msgs::msg::Odometry>::isSubscribed() )
+  {
+    BasicPublisher<nav_msgs::msg::Odometry>::publish( odom_msg );
+  }
+
+  if ( publish_tf_ )
+  {
+    geometry_msgs::msg::TransformStamped msg_tf_odom;
+    msg_tf_odom.header = odom_msg.header;
+    msg_tf_odom.child_frame_id = odom_msg.child_frame_id;
+    msg_tf_odom.transform.translation.x = odom_msg.pose.pose.position.x;
+    msg_tf_odom.transform.translation.y = odom_msg.pose.pose.position.y;
+    msg_tf_odom.transform.translation.z = odom_msg.pose.pose.position.z;
+    msg_tf_odom.transform.rotation = odom_msg.pose.pose.orientation;
+    tf_broadcasterPtr_->sendTransform( msg_tf_odom );
+  }
+}
+
+void OdomPublisher::reset( rclcpp::Node* node )
+{
+  BasicPublisher<nav_msgs::msg::Odometry>::reset( node );
+
+  if ( publish_tf_ )
+  {
+    tf_broadcasterPtr_ = boost::make_shared<tf2_ros::TransformBroadcaster>( node );
+  }
+}
+
+bool OdomPublisher::isSubscribed() const
+{
+  // TF is essential, so publish always when it is handled here
+  if ( publish_tf_ )
+  {
+    return is_initialized_;
+  }
+  return BasicPublisher<nav_msgs::msg::Odometry>::isSubscribed();
+}
+
+} //publisher
+} // naoqi
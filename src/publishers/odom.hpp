@@ -0,0 +1,65 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef ODOM_PUBLISHER_HPP
+#define ODOM_PUBLISHER_HPP
+
+/*
+* LOCAL includes
+*/
+#include "basic.hpp"
+
+/*
+* ROS includes
+*/
+#include <rclcpp/rclcpp.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+#include <tf2_ros/transform_broadcaster.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace naoqi
+{
+namespace publisher
+{
+
+/**
+ * @brief Publish odometry, and optionally the matching odom->base_link transform
+ */
+class OdomPublisher : public BasicPublisher<nav_msgs::msg::Odometry>
+{
+
+public:
+  OdomPublisher( const std::string& topic, bool publish_tf = false );
+
+  virtual void publish( const nav_msgs::msg::Odometry& odom_msg );
+
+  virtual void reset( rclcpp::Node* node );
+
+  virtual bool isSubscribed() const;
+
+private:
+  bool publish_tf_;
+
+  boost::shared_ptr<tf2_ros::TransformBroadcaster> tf_broadcasterPtr_;
+
+}; // class
+
+} //publisher
+} // naoqi
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "proprioception.hpp"
+
+namespace naoqi
+{
+namespace publisher
+{
+
+ProprioceptionPublisher::ProprioceptionPublisher( const std::string& joint_states_topic,
+                                                  const std::vector<std::string>& imu_topics,
+                                                  const std::string& odom_topic ):
+  joint_states_pub_( joint_states_topic ),
+  odom_pub_( odom_topic ),
+  is_initialized_( false )
+{
+  for( size_t i=0; i<imu_topics.size(); ++i )
+  {
+    imu_pubs_.push_back( boost::make_shared<BasicPublisher<sensor_msgs::msg::Imu> >( imu_topics[i], rclcpp::SensorDataQoS() ) );
+  }
+}
+
+void ProprioceptionPublisher::publish( const sensor_msgs::msg::JointState& js_msg,
+                                       const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms,
+                                       const std::vector<sensor_msgs::msg::Imu>& imu_msgs,
+                                       const nav_msgs::msg::Odometry& odom_msg )
+{
+  joint_states_pub_.publish( js_msg, tf_transforms );
+
+  if ( imu_pubs_.size() != imu_msgs.size() )
+  {
+    std::cerr << "Incorrect number of imu messages in proprioception publisher. " << imu_msgs.size() << "/" << imu_pubs_.size() << std::endl;
+  }
+  else
+  {
+    for( size_t i=0; i<imu_msgs.size(); ++i )
+    {
+      if ( imu_pubs_[i]->isSubscribed() )
+        imu_pubs_[i]->publish( imu_msgs[i] );
+    }
+  }
+
+  if ( odom_pub_.isSubscribed() )
+    odom_pub_.publish( odom_msg );
+}
+
+void ProprioceptionPublisher::reset( rclcpp::Node* node )
+{
+  joint_states_pub_.reset( node );
+  for( size_t i=0; i<imu_pubs_.size(); ++i )
+  {
+    imu_pubs_[i]->reset( node );
+  }
+  odom_pub_.reset( node );
+
+  is_initialized_ = true;
+}
+
+} //publisher
+} // naoqi
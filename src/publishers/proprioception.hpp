@@ -0,0 +1,85 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef PROPRIOCEPTION_PUBLISHER_HPP
+#define PROPRIOCEPTION_PUBLISHER_HPP
+
+/*
+* LOCAL includes
+*/
+#include "basic.hpp"
+#include "joint_state.hpp"
+
+/*
+* ROS includes
+*/
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/imu.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+
+namespace naoqi
+{
+namespace publisher
+{
+
+/**
+ * @brief Publish the output of the proprioception converter on the usual
+ * /joint_states, /tf, imu and odom topics
+ */
+class ProprioceptionPublisher
+{
+public:
+  ProprioceptionPublisher( const std::string& joint_states_topic,
+                           const std::vector<std::string>& imu_topics,
+                           const std::string& odom_topic );
+
+  inline std::string topic() const
+  {
+    return "proprioception";
+  }
+
+  inline bool isInitialized() const
+  {
+    return is_initialized_;
+  }
+
+  void publish( const sensor_msgs::msg::JointState& js_msg,
+                const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms,
+                const std::vector<sensor_msgs::msg::Imu>& imu_msgs,
+                const nav_msgs::msg::Odometry& odom_msg );
+
+  void reset( rclcpp::Node* node );
+
+  inline bool isSubscribed() const
+  {
+    // joint states and TF are always published
+    return is_initialized_;
+  }
+
+private:
+  JointStatePublisher joint_states_pub_;
+  std::vector< boost::shared_ptr<BasicPublisher<sensor_msgs::msg::Imu> > > imu_pubs_;
+  BasicPublisher<nav_msgs::msg::Odometry> odom_pub_;
+
+  bool is_initialized_;
+
+}; // class
+
+} //publisher
+} // naoqi
+
+#endif
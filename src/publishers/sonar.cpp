@@ -41,16 +41,19 @@ void SonarPublisher::publish( const std::vector<sensor_msgs::msg::Range>& sonar_
 
   for( size_t i=0; i<sonar_msgs.size(); ++i)
   {
-    pubs_[i]->publish( sonar_msgs[i] );
+    helpers::publishCopy( *pubs_[i], sonar_msgs[i] );
   }
 }
 
 void SonarPublisher::reset( rclcpp::Node* node )
 {
   pubs_.clear();
+  subscribers_.clear();
   for( size_t i=0; i<topics_.size(); ++i)
   {
-    pubs_.push_back( node->create_publisher<sensor_msgs::msg::Range>(topics_[i], 1) );
+    const rclcpp::QoS& qos = helpers::Node::qos(topics_[i], rclcpp::QoS(1));
+    pubs_.push_back( node->create_publisher<sensor_msgs::msg::Range>(topics_[i], qos, helpers::Node::publisher_options(qos)) );
+    subscribers_.push_back( helpers::Node::watch_subscribers(pubs_.back()->get_topic_name()) );
   }
 
   is_initialized_ = true;
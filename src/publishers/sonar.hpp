@@ -53,8 +53,9 @@ public:
   inline bool isSubscribed() const
   {
     if (is_initialized_ == false) return false;
-    for(std::vector<rclcpp::Publisher<sensor_msgs::msg::Range>::SharedPtr>::const_iterator it = pubs_.begin(); it != pubs_.end(); ++it)
-      if (helpers::Node::count_subscribers((*it)->get_topic_name()))
+    helpers::Node::refresh_subscribers();
+    for(std::vector<boost::shared_ptr<const std::atomic<size_t> > >::const_iterator it = subscribers_.begin(); it != subscribers_.end(); ++it)
+      if (**it > 0)
         return true;
     return false;
   }
@@ -62,6 +63,7 @@ public:
 private:
   std::vector<std::string> topics_;
   std::vector<rclcpp::Publisher<sensor_msgs::msg::Range>::SharedPtr> pubs_;
+  std::vector<boost::shared_ptr<const std::atomic<size_t> > > subscribers_;
   bool is_initialized_;
 
 };
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "proprioception.hpp"
+
+namespace naoqi
+{
+namespace recorder
+{
+
+ProprioceptionRecorder::ProprioceptionRecorder( const std::string& joint_states_topic,
+                                                const std::vector<std::string>& imu_topics,
+                                                const std::string& odom_topic,
+                                                float buffer_frequency ):
+  joint_states_rec_( joint_states_topic, buffer_frequency ),
+  odom_rec_( odom_topic, buffer_frequency ),
+  is_initialized_( false ),
+  is_subscribed_( false )
+{
+  for( size_t i=0; i<imu_topics.size(); ++i )
+  {
+    imu_recs_.push_back( boost::make_shared<BasicRecorder<sensor_msgs::msg::Imu> >( imu_topics[i], buffer_frequency ) );
+  }
+}
+
+void ProprioceptionRecorder::write( const sensor_msgs::msg::JointState& js_msg,
+                                    const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms,
+                                    const std::vector<sensor_msgs::msg::Imu>& imu_msgs,
+                                    const nav_msgs::msg::Odometry& odom_msg )
+{
+  joint_states_rec_.write( js_msg, tf_transforms );
+  for( size_t i=0; i<imu_msgs.size() && i<imu_recs_.size(); ++i )
+  {
+    imu_recs_[i]->write( imu_msgs[i] );
+  }
+  odom_rec_.write( odom_msg );
+}
+
+void ProprioceptionRecorder::bufferize( const sensor_msgs::msg::JointState& js_msg,
+                                        const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms,
+                                        const std::vector<sensor_msgs::msg::Imu>& imu_msgs,
+                                        const nav_msgs::msg::Odometry& odom_msg )
+{
+  joint_states_rec_.bufferize( js_msg, tf_transforms );
+  for( size_t i=0; i<imu_msgs.size() && i<imu_recs_.size(); ++i )
+  {
+    imu_recs_[i]->bufferize( imu_msgs[i] );
+  }
+  odom_rec_.bufferize( odom_msg );
+}
+
+void ProprioceptionRecorder::writeDump(const rclcpp::Time& time)
+{
+  joint_states_rec_.writeDump( time );
+  for( size_t i=0; i<imu_recs_.size(); ++i )
+  {
+    imu_recs_[i]->writeDump( time );
+  }
+  odom_rec_.writeDump( time );
+}
+
+void ProprioceptionRecorder::reset(boost::shared_ptr<GlobalRecorder> gr, float conv_frequency)
+{
+  joint_states_rec_.reset( gr, conv_frequency );
+  for( size_t i=0; i<imu_recs_.size(); ++i )
+  {
+    imu_recs_[i]->reset( gr, conv_frequency );
+  }
+  odom_rec_.reset( gr, conv_frequency );
+  is_initialized_ = true;
+}
+
+void ProprioceptionRecorder::setBufferDuration(float duration)
+{
+  joint_states_rec_.setBufferDuration( duration );
+  for( size_t i=0; i<imu_recs_.size(); ++i )
+  {
+    imu_recs_[i]->setBufferDuration( duration );
+  }
+  odom_rec_.setBufferDuration( duration );
+}
+
+} //recorder
+} // naoqi
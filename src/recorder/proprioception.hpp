@@ -0,0 +1,100 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef PROPRIOCEPTION_RECORDER_HPP
+#define PROPRIOCEPTION_RECORDER_HPP
+
+/*
+* LOCAL includes
+*/
+#include "basic.hpp"
+#include "joint_state.hpp"
+
+/*
+* ROS includes
+*/
+#include <sensor_msgs/msg/imu.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+
+namespace naoqi
+{
+namespace recorder
+{
+
+/**
+ * @brief Record the output of the proprioception converter on the usual
+ * /joint_states, /tf, imu and odom topics
+ */
+class ProprioceptionRecorder
+{
+
+public:
+  ProprioceptionRecorder( const std::string& joint_states_topic,
+                          const std::vector<std::string>& imu_topics,
+                          const std::string& odom_topic,
+                          float buffer_frequency = 0 );
+
+  void write( const sensor_msgs::msg::JointState& js_msg,
+              const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms,
+              const std::vector<sensor_msgs::msg::Imu>& imu_msgs,
+              const nav_msgs::msg::Odometry& odom_msg );
+
+  void reset( boost::shared_ptr<naoqi::recorder::GlobalRecorder> gr, float conv_frequency );
+
+  void bufferize( const sensor_msgs::msg::JointState& js_msg,
+                  const std::vector<geometry_msgs::msg::TransformStamped>& tf_transforms,
+                  const std::vector<sensor_msgs::msg::Imu>& imu_msgs,
+                  const nav_msgs::msg::Odometry& odom_msg );
+
+  void writeDump(const rclcpp::Time& time);
+
+  void setBufferDuration(float duration);
+
+  inline std::string topic() const
+  {
+    return "proprioception";
+  }
+
+  inline bool isInitialized() const
+  {
+    return is_initialized_;
+  }
+
+  inline void subscribe( bool state)
+  {
+    is_subscribed_ = state;
+  }
+
+  inline bool isSubscribed() const
+  {
+    return is_subscribed_;
+  }
+
+protected:
+  JointStateRecorder joint_states_rec_;
+  std::vector< boost::shared_ptr<BasicRecorder<sensor_msgs::msg::Imu> > > imu_recs_;
+  BasicRecorder<nav_msgs::msg::Odometry> odom_rec_;
+
+  bool is_initialized_;
+  bool is_subscribed_;
+
+}; // class
+
+} //recorder
+} // naoqi
+
+#endif
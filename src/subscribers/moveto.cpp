@@ -28,17 +28,61 @@
 
 #include "../helpers/transform_helpers.hpp"
 
+namespace ph = boost::placeholders;
+
 namespace naoqi
 {
 namespace subscriber
 {
 
+// a goal waits that long for a transform before being dropped
+static const double kPendingGoalTimeout = 2.0;
+// transforms older than that are not used to place a new goal
+static const double kTransformMaxAge = 0.5;
+
 MovetoSubscriber::MovetoSubscriber( const std::string& name, const std::string& topic, const qi::SessionPtr& session,
-                                    const boost::shared_ptr<tf2_ros::Buffer>& tf2_buffer):
+                                    const boost::shared_ptr<tools::TransformCache>& transform_cache):
   BaseSubscriber( name, topic, session ),
-  p_motion_( session->service("ALMotion").value() ),
-  tf2_buffer_( tf2_buffer )
-{}
+  p_motion_( helpers::driver::getService( session, "ALMotion" ) ),
+  transform_cache_( transform_cache ),
+  has_pending_goal_( false )
+{
+}
+
+MovetoSubscriber::~MovetoSubscriber()
+{
+  boost::mutex::scoped_lock lock( goal_mutex_ );
+  clearPendingGoal();
+}
+
+void MovetoSubscriber::setPendingGoal( const geometry_msgs::msg::PoseStamped& pose_msg, const rclcpp::Time& now )
+{
+  if ( !has_pending_goal_ )
+  {
+    // goals in odom are brought back in base_footprint with the joint states transforms,
+    // which are only indexed while a goal waits for them
+    transform_cache_->registerInterest( "base_footprint", "odom" );
+    listener_id_ = transform_cache_->addListener( boost::bind( &MovetoSubscriber::onTransformUpdate, this, ph::_1 ) );
+  }
+  pending_goal_ = pose_msg;
+  pending_since_ = now;
+  has_pending_goal_ = true;
+}
+
+void MovetoSubscriber::clearPendingGoal()
+{
+  if ( !has_pending_goal_ )
+    return;
+  transform_cache_->removeListener( listener_id_ );
+  transform_cache_->releaseInterest( "base_footprint", "odom" );
+  has_pending_goal_ = false;
+}
+
+void MovetoSubscriber::reconnect()
+{
+  boost::mutex::scoped_lock lock( goal_mutex_ );
+  p_motion_ = helpers::driver::getService( session_, "ALMotion" );
+}
 
 void MovetoSubscriber::reset( rclcpp::Node* node )
 {
@@ -53,75 +97,25 @@ void MovetoSubscriber::reset( rclcpp::Node* node )
 void MovetoSubscriber::callback( const geometry_msgs::msg::PoseStamped::SharedPtr pose_msg )
 {
   if (pose_msg->header.frame_id == "odom") {
-    geometry_msgs::msg::PoseStamped pose_msg_bf;
-
-    bool canTransform = tf2_buffer_->canTransform(
-      "base_footprint",
-      "odom",
-      tf2::get_now(),
-      tf2::Duration(2));
-
-    if (!canTransform) {
-      std::cout << "Cannot transform from "
-                << "odom"
-                << " to base_footprint"
-                << std::endl;
+    // never wait for the transform here, it would stall the other callbacks
+    boost::mutex::scoped_lock lock( goal_mutex_ );
+    const rclcpp::Time now = helpers::Time::now();
+    if ( tryMoveTo( *pose_msg, now ) )
+    {
+      clearPendingGoal();
       return;
     }
 
-    try {
-      tf2_buffer_->transform(
-        *pose_msg,
-        pose_msg_bf,
-        "base_footprint",
-        tf2::get_now(),
-        "odom");
-
-      double yaw = helpers::transform::getYaw(pose_msg_bf.pose);
-
-      std::cout << "odom to move x: " <<  pose_msg_bf.pose.position.x
-                << " y: " << pose_msg_bf.pose.position.y
-                << " yaw: " << yaw << std::endl;
-
-      if (std::isnan(yaw)) {
-        yaw = 0.0;
-        std::cout << "Yaw is nan, changed to 0.0" << std::endl;
-      }
-
-      p_motion_.async<void>(
-        "moveTo",
-        pose_msg_bf.pose.position.x,
-        pose_msg_bf.pose.position.y,
-        yaw);
-
-    } catch( const tf2::LookupException& e) {
-      std::cout << e.what() << std::endl;
-      std::cout << "moveto position in frame_id "
-                << pose_msg->header.frame_id
-                << "is not supported in any other base frame than "
-                   "basefootprint"
-                << std::endl;
-    } catch( const tf2::ExtrapolationException& e) {
-      std::cout << "received an error on the time lookup" << std::endl;
+    if ( has_pending_goal_ )
+    {
+      std::cout << "moveto goal replaced before odom to base_footprint was available" << std::endl;
     }
+    setPendingGoal( *pose_msg, now );
   }
   else if (pose_msg->header.frame_id == "base_footprint"){
-    double yaw = helpers::transform::getYaw(pose_msg->pose);
-    std::cout << "going to move x: "
-              <<  pose_msg->pose.position.x
-              << " y: " << pose_msg->pose.position.y
-              << " yaw: " << yaw << std::endl;
-
-    if (std::isnan(yaw)) {
-      yaw = 0.0;
-      std::cout << "Yaw is nan, changed to 0.0" << std::endl;
-    }
-
-    p_motion_.async<void>(
-      "moveTo",
-      pose_msg->pose.position.x,
-      pose_msg->pose.position.y,
-      yaw);
+    boost::mutex::scoped_lock lock( goal_mutex_ );
+    clearPendingGoal();
+    moveTo( pose_msg->pose );
   }
 
   else
@@ -132,5 +126,66 @@ void MovetoSubscriber::callback( const geometry_msgs::msg::PoseStamped::SharedPt
               << std::endl;
 }
 
+void MovetoSubscriber::onTransformUpdate( const rclcpp::Time& stamp )
+{
+  boost::mutex::scoped_lock lock( goal_mutex_ );
+  if ( !has_pending_goal_ )
+    return;
+
+  // a goal that waited too long is dropped rather than run late
+  if ( stamp.seconds() - pending_since_.seconds() > kPendingGoalTimeout )
+  {
+    std::cout << "Cannot transform from "
+              << "odom"
+              << " to base_footprint"
+              << std::endl;
+    clearPendingGoal();
+  }
+  else if ( tryMoveTo( pending_goal_, stamp ) )
+  {
+    clearPendingGoal();
+  }
+}
+
+bool MovetoSubscriber::tryMoveTo( const geometry_msgs::msg::PoseStamped& pose_msg, const rclcpp::Time& now )
+{
+  geometry_msgs::msg::TransformStamped tf_odom_to_base;
+  if ( !transform_cache_->lookupLatest( "base_footprint", "odom", tf_odom_to_base )
+       || now.seconds() - rclcpp::Time( tf_odom_to_base.header.stamp ).seconds() > kTransformMaxAge )
+  {
+    return false;
+  }
+
+  geometry_msgs::msg::PoseStamped pose_msg_bf;
+  tf2::doTransform( pose_msg, pose_msg_bf, tf_odom_to_base );
+  moveTo( pose_msg_bf.pose );
+  return true;
+}
+
+void MovetoSubscriber::moveTo( const geometry_msgs::msg::Pose& pose )
+{
+  double yaw = helpers::transform::getYaw(pose);
+  std::cout << "going to move x: "
+            <<  pose.position.x
+            << " y: " << pose.position.y
+            << " yaw: " << yaw << std::endl;
+
+  if (std::isnan(yaw)) {
+    yaw = 0.0;
+    std::cout << "Yaw is nan, changed to 0.0" << std::endl;
+  }
+
+  // a new moveTo interrupts the one in flight
+  if ( moving_.isValid() && !moving_.isFinished() )
+  {
+    std::cout << "previous moveto goal superseded" << std::endl;
+  }
+  moving_ = p_motion_.async<void>(
+    "moveTo",
+    pose.position.x,
+    pose.position.y,
+    yaw);
+}
+
 } //publisher
 } // naoqi
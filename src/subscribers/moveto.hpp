@@ -23,13 +23,18 @@
  * LOCAL includes
  */
 #include "subscriber_base.hpp"
+#include "../tools/transform_cache.hpp"
+
+/*
+ * BOOST includes
+ */
+#include <boost/thread/mutex.hpp>
+
 /*
  * ROS includes
  */
 #include "rclcpp/rclcpp.hpp"
 #include <geometry_msgs/msg/pose_stamped.hpp>
-#include <tf2_ros/buffer.h>
-#include <tf2/time.h>
 
 namespace naoqi
 {
@@ -39,16 +44,37 @@ namespace subscriber
 class MovetoSubscriber: public BaseSubscriber<MovetoSubscriber>
 {
 public:
-  MovetoSubscriber( const std::string& name, const std::string& topic, const qi::SessionPtr& session, const boost::shared_ptr<tf2_ros::Buffer>& tf2_buffer );
-  ~MovetoSubscriber(){}
+  MovetoSubscriber( const std::string& name, const std::string& topic, const qi::SessionPtr& session, const boost::shared_ptr<tools::TransformCache>& transform_cache );
+  ~MovetoSubscriber();
 
   void reset( rclcpp::Node* node );
+
+  void reconnect();
+
   void callback( const geometry_msgs::msg::PoseStamped::SharedPtr pose_msg );
 
 private:
+  /** resolve the pending goal once the transforms of a new tick are available */
+  void onTransformUpdate( const rclcpp::Time& stamp );
+  /** keep the goal until the transform is available, listening to the transform updates meanwhile */
+  void setPendingGoal( const geometry_msgs::msg::PoseStamped& pose_msg, const rclcpp::Time& now );
+  void clearPendingGoal();
+  /** send the goal if the transform to base_footprint is recent enough */
+  bool tryMoveTo( const geometry_msgs::msg::PoseStamped& pose_msg, const rclcpp::Time& now );
+  void moveTo( const geometry_msgs::msg::Pose& pose );
+
   qi::AnyObject p_motion_;
   rclcpp::Subscription<geometry_msgs::msg::PoseStamped>::SharedPtr sub_moveto_;
-  boost::shared_ptr<tf2_ros::Buffer> tf2_buffer_;
+  boost::shared_ptr<tools::TransformCache> transform_cache_;
+  size_t listener_id_;
+
+  /** latest goal in odom waiting for a transform, a newer goal replaces it */
+  boost::mutex goal_mutex_;
+  bool has_pending_goal_;
+  geometry_msgs::msg::PoseStamped pending_goal_;
+  rclcpp::Time pending_since_;
+
+  qi::Future<void> moving_;
 }; // class Teleop
 
 } // subscriber
@@ -29,9 +29,14 @@ namespace subscriber
 SpeechSubscriber::SpeechSubscriber( const std::string& name, const std::string& speech_topic, const qi::SessionPtr& session ):
   speech_topic_(speech_topic),
   BaseSubscriber( name, speech_topic, session ),
-  p_tts_(session->service("ALTextToSpeech").value())
+  p_tts_(helpers::driver::getService( session, "ALTextToSpeech" ))
 {}
 
+void SpeechSubscriber::reconnect()
+{
+  p_tts_ = helpers::driver::getService( session_, "ALTextToSpeech" );
+}
+
 void SpeechSubscriber::reset(rclcpp::Node* node )
 {
   sub_speech_ = node->create_subscription<std_msgs::msg::String>(
@@ -42,6 +42,9 @@ public:
   ~SpeechSubscriber(){}
 
   void reset( rclcpp::Node* node );
+
+  void reconnect();
+
   void speech_callback( const std_msgs::msg::String::SharedPtr msg );
 
 private:
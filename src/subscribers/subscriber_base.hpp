@@ -65,13 +65,18 @@ public:
     return is_initialized_;
   }
 
+  /** subscribers holding proxies resolve them again here */
+  inline void reconnect()
+  {
+  }
+
 protected:
   std::string name_, topic_;
 
   bool is_initialized_;
 
   /** The type of the robot */
-  const robot::Robot& robot_;
+  const robot::Robot robot_;
 
   /** Pointer to a session from which we can create proxies */
   qi::SessionPtr session_;
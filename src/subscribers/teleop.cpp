@@ -19,6 +19,12 @@
  * LOCAL includes
  */
 #include "teleop.hpp"
+#include <naoqi_driver/ros_helpers.hpp>
+
+/*
+ * STANDARD includes
+ */
+#include <algorithm>
 
 
 namespace naoqi
@@ -30,9 +36,49 @@ TeleopSubscriber::TeleopSubscriber( const std::string& name, const std::string&
   cmd_vel_topic_(cmd_vel_topic),
   joint_angles_topic_(joint_angles_topic),
   BaseSubscriber( name, cmd_vel_topic, session ),
-  p_motion_( session->service("ALMotion").value() )
+  p_motion_( helpers::driver::getService( session, "ALMotion" ) ),
+  control_rate_( 20.0f ),
+  cmd_vel_timeout_( 0.5f ),
+  vel_x_( 0.0f ),
+  vel_y_( 0.0f ),
+  vel_th_( 0.0f ),
+  cmd_vel_changed_( false ),
+  is_moving_( false ),
+  cmd_vel_count_( 0 ),
+  cmd_vel_sent_( 0 ),
+  cmd_vel_dropped_( 0 ),
+  watchdog_stops_( 0 ),
+  joint_angles_pending_( 0 ),
+  joint_angles_flushing_( false ),
+  joint_angles_count_( 0 ),
+  joint_angles_calls_( 0 )
 {}
 
+TeleopSubscriber::~TeleopSubscriber()
+{
+  control_thread_.interrupt();
+  control_thread_.join();
+}
+
+void TeleopSubscriber::setControl( float control_rate, float cmd_vel_timeout )
+{
+  control_rate_ = control_rate;
+  cmd_vel_timeout_ = cmd_vel_timeout;
+}
+
+void TeleopSubscriber::reconnect()
+{
+  qi::AnyObject p_motion = helpers::driver::getService( session_, "ALMotion" );
+  boost::mutex::scoped_lock lock( motion_mutex_ );
+  p_motion_ = p_motion;
+}
+
+qi::AnyObject TeleopSubscriber::motion()
+{
+  boost::mutex::scoped_lock lock( motion_mutex_ );
+  return p_motion_;
+}
+
 void TeleopSubscriber::reset( rclcpp::Node* node )
 {
   sub_cmd_vel_ = node->create_subscription<geometry_msgs::msg::Twist>(
@@ -45,6 +91,11 @@ void TeleopSubscriber::reset( rclcpp::Node* node )
     10,
     std::bind(&TeleopSubscriber::joint_angles_callback, this, std::placeholders::_1));
 
+  if ( control_rate_ > 0 && control_thread_.get_id() == boost::thread::id() )
+  {
+    control_thread_ = boost::thread( &TeleopSubscriber::controlLoop, this );
+  }
+
   is_initialized_ = true;
 }
 
@@ -55,19 +106,218 @@ void TeleopSubscriber::cmd_vel_callback( const geometry_msgs::msg::Twist::Shared
   const float& vel_y = twist_msg->linear.y;
   const float& vel_th = twist_msg->angular.z;
 
-  std::cout << "going to move x: " << vel_x << " y: " << vel_y << " th: " << vel_th << std::endl;
-  p_motion_.async<void>("move", vel_x, vel_y, vel_th );
+  if ( control_rate_ <= 0 )
+  {
+    motion().async<void>("move", vel_x, vel_y, vel_th );
+    return;
+  }
+
+  // only keep the latest command, the control loop sends it
+  boost::mutex::scoped_lock lock( cmd_vel_mutex_ );
+  if ( cmd_vel_changed_ )
+  {
+    ++cmd_vel_dropped_;
+  }
+  cmd_vel_changed_ = cmd_vel_changed_ || vel_x != vel_x_ || vel_y != vel_y_ || vel_th != vel_th_;
+  vel_x_ = vel_x;
+  vel_y_ = vel_y;
+  vel_th_ = vel_th;
+  cmd_vel_received_ = boost::chrono::steady_clock::now();
+  ++cmd_vel_count_;
+}
+
+void TeleopSubscriber::sendMove( float vel_x, float vel_y, float vel_th )
+{
+  moving_ = motion().async<void>("move", vel_x, vel_y, vel_th );
+  is_moving_ = vel_x != 0 || vel_y != 0 || vel_th != 0;
+  ++cmd_vel_sent_;
+}
+
+void TeleopSubscriber::controlLoop()
+{
+  const boost::chrono::nanoseconds period( static_cast<int64_t>(1e9 / control_rate_) );
+  TimePoint next = boost::chrono::steady_clock::now();
+  try
+  {
+    while ( true )
+    {
+      next += period;
+      boost::this_thread::sleep_until( next );
+
+      const TimePoint now = boost::chrono::steady_clock::now();
+      updateCmdVel( now );
+      flushJointAngles( now );
+      report();
+    }
+  }
+  catch (const boost::thread_interrupted&)
+  {
+  }
+}
+
+void TeleopSubscriber::updateCmdVel( const TimePoint& now )
+{
+  const boost::chrono::nanoseconds timeout( static_cast<int64_t>(1e9 * cmd_vel_timeout_) );
+  boost::mutex::scoped_lock lock( cmd_vel_mutex_ );
+
+  // never more than one move in flight
+  if ( moving_.isValid() && !moving_.isFinished() )
+    return;
+
+  if ( cmd_vel_changed_ )
+  {
+    sendMove( vel_x_, vel_y_, vel_th_ );
+    cmd_vel_changed_ = false;
+    cmd_vel_latency_.add( boost::chrono::duration<double, boost::milli>( now - cmd_vel_received_ ).count() );
+  }
+  else if ( is_moving_ && timeout.count() > 0 && now - cmd_vel_received_ > timeout )
+  {
+    std::cout << "No cmd_vel received for " << cmd_vel_timeout_ << " s, stopping the robot" << std::endl;
+    sendMove( 0.0f, 0.0f, 0.0f );
+    vel_x_ = vel_y_ = vel_th_ = 0.0f;
+    ++watchdog_stops_;
+  }
+}
+
+void TeleopSubscriber::flushJointAngles( const TimePoint& now )
+{
+  std::map<std::string, JointCommand> absolute, relative;
+  TimePoint oldest;
+  size_t merged_count;
+  {
+    boost::mutex::scoped_lock lock( joint_angles_mutex_ );
+    // a single flusher at a time, so that the calls keep the order of the commands
+    if ( joint_angles_pending_ == 0 || joint_angles_flushing_ )
+      return;
+    joint_angles_flushing_ = true;
+    absolute.swap( joint_angles_absolute_ );
+    relative.swap( joint_angles_relative_ );
+    oldest = joint_angles_oldest_;
+    merged_count = joint_angles_pending_;
+    joint_angles_pending_ = 0;
+  }
+
+  // ALMotion takes a single speed per call, so there is one call per distinct speed
+  std::vector<qi::Future<void> > in_flight;
+  size_t calls = sendJointAngles( "setAngles", absolute, in_flight ) + sendJointAngles( "changeAngles", relative, in_flight );
+
+  boost::mutex::scoped_lock lock( joint_angles_mutex_ );
+  joint_angles_flushing_ = false;
+  joint_angles_in_flight_.swap( in_flight );
+  joint_angles_count_ += merged_count;
+  joint_angles_calls_ += calls;
+  joint_angles_latency_.add( boost::chrono::duration<double, boost::milli>( now - oldest ).count() );
+}
+
+size_t TeleopSubscriber::sendJointAngles( const std::string& method, const std::map<std::string, JointCommand>& commands,
+                                          std::vector<qi::Future<void> >& calls )
+{
+  std::map<float, std::pair<std::vector<std::string>, std::vector<float> > > by_speed;
+  for ( std::map<std::string, JointCommand>::const_iterator it = commands.begin(); it != commands.end(); ++it )
+  {
+    by_speed[it->second.speed].first.push_back( it->first );
+    by_speed[it->second.speed].second.push_back( it->second.angle );
+  }
+  qi::AnyObject p_motion = motion();
+  for ( std::map<float, std::pair<std::vector<std::string>, std::vector<float> > >::const_iterator it = by_speed.begin();
+        it != by_speed.end(); ++it )
+  {
+    calls.push_back( p_motion.async<void>( method, it->second.first, it->second.second, it->first ) );
+  }
+  return by_speed.size();
+}
+
+void TeleopSubscriber::report()
+{
+  if ( !report_.due() )
+    return;
+
+  boost::mutex::scoped_lock cmd_vel_lock( cmd_vel_mutex_ );
+  boost::mutex::scoped_lock joint_angles_lock( joint_angles_mutex_ );
+  if ( cmd_vel_count_ > 0 )
+  {
+    RCLCPP_DEBUG( helpers::Node::get_logger(), "cmd_vel: %zu received, %zu sent, %zu coalesced, %zu watchdog stops, latency mean %.2f ms, max %.2f ms",
+                  cmd_vel_count_, cmd_vel_sent_, cmd_vel_dropped_, watchdog_stops_, cmd_vel_latency_.mean(), cmd_vel_latency_.max() );
+  }
+  if ( joint_angles_count_ > 0 )
+  {
+    RCLCPP_DEBUG( helpers::Node::get_logger(), "joint_angles: %zu received, %zu calls (merge ratio %.2f), latency mean %.2f ms, max %.2f ms",
+                  joint_angles_count_, joint_angles_calls_,
+                  static_cast<double>(joint_angles_count_) / std::max<size_t>( joint_angles_calls_, 1 ),
+                  joint_angles_latency_.mean(), joint_angles_latency_.max() );
+  }
+  cmd_vel_count_ = cmd_vel_sent_ = cmd_vel_dropped_ = watchdog_stops_ = 0;
+  cmd_vel_latency_.reset();
+  joint_angles_count_ = joint_angles_calls_ = 0;
+  joint_angles_latency_.reset();
 }
 
 void TeleopSubscriber::joint_angles_callback( const naoqi_bridge_msgs::msg::JointAnglesWithSpeed::SharedPtr  js_msg )
 {
-  if ( js_msg->relative==0 )
+  if ( control_rate_ <= 0 )
+  {
+    if ( js_msg->relative==0 )
+    {
+      motion().async<void>("setAngles", js_msg->joint_names, js_msg->joint_angles, js_msg->speed);
+    }
+    else
+    {
+      motion().async<void>("changeAngles", js_msg->joint_names, js_msg->joint_angles, js_msg->speed);
+    }
+    return;
+  }
+
+  // merge per joint while calls are in flight, the last writer wins
+  const TimePoint now = boost::chrono::steady_clock::now();
+  bool is_idle = true;
   {
-    p_motion_.async<void>("setAngles", js_msg->joint_names, js_msg->joint_angles, js_msg->speed);
+    boost::mutex::scoped_lock lock( joint_angles_mutex_ );
+    if ( joint_angles_pending_ == 0 )
+    {
+      joint_angles_oldest_ = now;
+    }
+    ++joint_angles_pending_;
+
+    for ( size_t i=0; i<js_msg->joint_names.size() && i<js_msg->joint_angles.size(); ++i )
+    {
+      const std::string& joint = js_msg->joint_names[i];
+      if ( js_msg->relative==0 )
+      {
+        joint_angles_absolute_[joint] = JointCommand( js_msg->joint_angles[i], js_msg->speed );
+        joint_angles_relative_.erase( joint );
+      }
+      else
+      {
+        // a change on top of a pending target moves the target
+        std::map<std::string, JointCommand>::iterator target = joint_angles_absolute_.find( joint );
+        std::map<std::string, JointCommand>& commands = ( target != joint_angles_absolute_.end() ) ? joint_angles_absolute_ : joint_angles_relative_;
+        std::map<std::string, JointCommand>::iterator it = commands.find( joint );
+        if ( it == commands.end() )
+        {
+          commands[joint] = JointCommand( js_msg->joint_angles[i], js_msg->speed );
+        }
+        else
+        {
+          it->second.angle += js_msg->joint_angles[i];
+          it->second.speed = js_msg->speed;
+        }
+      }
+    }
+
+    // send right away while ALMotion is idle, so that a stream keeps its own rate
+    for ( size_t i=0; i<joint_angles_in_flight_.size(); ++i )
+    {
+      if ( !joint_angles_in_flight_[i].isFinished() )
+      {
+        is_idle = false;
+        break;
+      }
+    }
+    is_idle = is_idle && !joint_angles_flushing_;
   }
-  else
+  if ( is_idle )
   {
-    p_motion_.async<void>("changeAngles", js_msg->joint_names, js_msg->joint_angles, js_msg->speed);
+    flushJointAngles( now );
   }
 }
 
@@ -23,6 +23,20 @@
  * LOCAL includes
  */
 #include "subscriber_base.hpp"
+#include "../tools/statistics.hpp"
+
+/*
+ * STANDARD includes
+ */
+#include <map>
+#include <vector>
+
+/*
+ * BOOST includes
+ */
+#include <boost/chrono.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 /*
  * ROS includes
@@ -40,22 +54,91 @@ class TeleopSubscriber: public BaseSubscriber<TeleopSubscriber>
 {
 public:
   TeleopSubscriber( const std::string& name, const std::string& cmd_vel_topic, const std::string& joint_angles_topic, const qi::SessionPtr& session );
-  ~TeleopSubscriber(){}
+  ~TeleopSubscriber();
+
+  /**
+   * @brief rate at which the latest velocity command is sent to ALMotion,
+   * and time without command after which the robot is stopped (0 to disable).
+   * Joint commands are sent as they arrive while no joint call is in flight,
+   * so a stream keeps its own rate; the ones arriving meanwhile are merged
+   * and sent by the next control period at the latest.
+   */
+  void setControl( float control_rate, float cmd_vel_timeout );
 
   void reset( rclcpp::Node* node );
+
+  void reconnect();
+
   void cmd_vel_callback( const geometry_msgs::msg::Twist::SharedPtr twist_msg );
   void joint_angles_callback( const naoqi_bridge_msgs::msg::JointAnglesWithSpeed::SharedPtr js_msg );
 
 private:
+  typedef boost::chrono::steady_clock::time_point TimePoint;
+
+  struct JointCommand
+  {
+    JointCommand( float angle = 0.0f, float speed = 0.0f ): angle( angle ), speed( speed ) {}
+    float angle;
+    float speed;
+  };
+
+  /** send the latest velocity command and the merged joint commands every control period */
+  void controlLoop();
+  /** send the latest velocity command when it changed, and stop the robot when commands stop */
+  void updateCmdVel( const TimePoint& now );
+  void sendMove( float vel_x, float vel_y, float vel_th );
+  /** send the joint commands merged since the last call, unless a flush is in progress */
+  void flushJointAngles( const TimePoint& now );
+  size_t sendJointAngles( const std::string& method, const std::map<std::string, JointCommand>& commands,
+                          std::vector<qi::Future<void> >& calls );
+  /** log the command statistics at debug level, once per report period */
+  void report();
+  /** copy of the motion proxy, which a reconnection replaces from another thread */
+  qi::AnyObject motion();
 
   std::string cmd_vel_topic_;
   std::string joint_angles_topic_;
 
+  boost::mutex motion_mutex_;
   qi::AnyObject p_motion_;
   rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr sub_cmd_vel_;
   rclcpp::Subscription<naoqi_bridge_msgs::msg::JointAnglesWithSpeed>::SharedPtr sub_joint_angles_;
 
+  float control_rate_;
+  float cmd_vel_timeout_;
+  boost::thread control_thread_;
+
+  /** latest velocity command, written by the callback and read by the control loop */
+  boost::mutex cmd_vel_mutex_;
+  float vel_x_, vel_y_, vel_th_;
+  bool cmd_vel_changed_;
+  TimePoint cmd_vel_received_;
+
+  /** only one move call in flight, the next command waits for it */
+  qi::Future<void> moving_;
+  bool is_moving_;
+
+  /** counters reported periodically */
+  size_t cmd_vel_count_;
+  size_t cmd_vel_sent_;
+  size_t cmd_vel_dropped_;
+  size_t watchdog_stops_;
+  tools::RunningStats cmd_vel_latency_;
+
+  /** joint commands merged per joint until the calls in flight return, or the next control period */
+  boost::mutex joint_angles_mutex_;
+  std::map<std::string, JointCommand> joint_angles_absolute_;
+  std::map<std::string, JointCommand> joint_angles_relative_;
+  size_t joint_angles_pending_;
+  TimePoint joint_angles_oldest_;
+  bool joint_angles_flushing_;
+  std::vector<qi::Future<void> > joint_angles_in_flight_;
+
+  size_t joint_angles_count_;
+  size_t joint_angles_calls_;
+  tools::RunningStats joint_angles_latency_;
 
+  tools::StatsReport report_;
 
 }; // class Teleop
 
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "clock_sync.hpp"
+#include "../helpers/driver_helpers.hpp"
+#include <naoqi_driver/ros_helpers.hpp>
+
+/*
+* STANDARD includes
+*/
+#include <algorithm>
+#include <limits>
+
+namespace naoqi
+{
+namespace tools
+{
+
+/** samples needed before trusting the DCM/Time mapping */
+static const size_t min_samples = 4;
+/** DCM/Time has a 1ms resolution, probes within that margin of the best one are kept */
+static const int64_t rtt_margin_ns = 1000000;
+/** a jump bigger than this means the DCM clock was reset */
+static const int64_t max_offset_jump_ns = 100000000;
+/** the drift is only fitted over a long enough span, and bounded */
+static const int64_t min_drift_span_ns = 5000000000LL;
+static const double max_drift = 500e-6;
+
+ClockSync::ClockSync( const qi::SessionPtr& session, float frequency, size_t window_size ):
+  p_memory_( helpers::driver::getService( session, "ALMemory" ) ),
+  frequency_( frequency ),
+  samples_( window_size ),
+  ref_remote_ns_( 0 ),
+  offset_ns_( 0 ),
+  drift_( 0.0 ),
+  min_rtt_ns_( 0 ),
+  is_synchronized_( false ),
+  is_latched_( false ),
+  window_size_( window_size )
+{
+}
+
+ClockSync::~ClockSync()
+{
+  stop();
+}
+
+void ClockSync::start()
+{
+  if ( thread_.joinable() )
+    return;
+  thread_ = boost::thread( &ClockSync::loop, this );
+}
+
+void ClockSync::stop()
+{
+  if ( !thread_.joinable() )
+    return;
+  thread_.interrupt();
+  thread_.join();
+}
+
+void ClockSync::reconnect( const qi::SessionPtr& session )
+{
+  const bool was_running = thread_.joinable();
+  stop();
+  p_memory_ = helpers::driver::getService( session, "ALMemory" );
+  if ( was_running )
+  {
+    start();
+  }
+  else if ( is_latched_ )
+  {
+    // the robot may have rebooted, its DCM clock with it
+    latch();
+  }
+}
+
+void ClockSync::latch()
+{
+  probe();
+  boost::mutex::scoped_lock lock( mutex_ );
+  if ( samples_.empty() )
+  {
+    std::cerr << "Could not latch the DCM clock offset, stamping with the reception time" << std::endl;
+    return;
+  }
+  is_synchronized_ = true;
+  is_latched_ = true;
+  std::cout << "DCM clock offset latched: " << offset_ns_ * 1e-9
+            << " s, round trip " << min_rtt_ns_ * 1e-6 << " ms" << std::endl;
+}
+
+void ClockSync::loop()
+{
+  const boost::chrono::milliseconds period( static_cast<int>(1000.0f / frequency_) );
+  try
+  {
+    while ( true )
+    {
+      // a burst of probes at start to synchronize quickly
+      probe();
+      if ( isSynchronized() )
+        boost::this_thread::sleep_for( period );
+      else
+        boost::this_thread::sleep_for( boost::chrono::milliseconds(50) );
+    }
+  }
+  catch ( const boost::thread_interrupted& )
+  {
+  }
+}
+
+void ClockSync::probe()
+{
+  int64_t dcm_time_ms = 0;
+  const int64_t t0 = helpers::Time::now().nanoseconds();
+  try
+  {
+    dcm_time_ms = p_memory_.call<qi::AnyValue>( "getData", "DCM/Time" ).toInt();
+  }
+  catch ( const std::exception& e )
+  {
+    std::cerr << "Clock synchronization probe failed: " << e.what() << std::endl;
+    return;
+  }
+  const int64_t t1 = helpers::Time::now().nanoseconds();
+
+  Sample sample;
+  sample.remote_ns = dcm_time_ms * 1000000;
+  sample.rtt_ns = t1 - t0;
+  // the remote clock was read somewhere within the round trip, assume the middle
+  sample.offset_ns = t0 + sample.rtt_ns / 2 - sample.remote_ns;
+
+  boost::mutex::scoped_lock lock( mutex_ );
+  if ( is_synchronized_ )
+  {
+    const int64_t predicted = offset_ns_ + static_cast<int64_t>( drift_ * (sample.remote_ns - ref_remote_ns_) );
+    if ( std::abs( sample.offset_ns - predicted ) > max_offset_jump_ns + sample.rtt_ns )
+    {
+      std::cout << "DCM clock reset detected, restarting clock synchronization" << std::endl;
+      samples_.clear();
+      is_synchronized_ = false;
+    }
+  }
+  samples_.push_back( sample );
+  estimate();
+}
+
+void ClockSync::estimate()
+{
+  if ( samples_.empty() )
+    return;
+
+  int64_t min_rtt = std::numeric_limits<int64_t>::max();
+  for ( boost::circular_buffer<Sample>::const_iterator it = samples_.begin(); it != samples_.end(); ++it )
+  {
+    min_rtt = std::min( min_rtt, it->rtt_ns );
+  }
+
+  // keep the probes with the tightest bound on the offset
+  const int64_t max_rtt = min_rtt + std::max( min_rtt / 2, rtt_margin_ns );
+  std::vector<const Sample*> best;
+  for ( boost::circular_buffer<Sample>::const_iterator it = samples_.begin(); it != samples_.end(); ++it )
+  {
+    if ( it->rtt_ns <= max_rtt )
+      best.push_back( &(*it) );
+  }
+
+  // least squares of offset = a + b * (remote - ref), relative to the latest probe
+  const int64_t ref = samples_.back().remote_ns;
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  int64_t min_x = std::numeric_limits<int64_t>::max();
+  int64_t max_x = std::numeric_limits<int64_t>::min();
+  for ( size_t i=0; i<best.size(); ++i )
+  {
+    const double x = static_cast<double>( best[i]->remote_ns - ref );
+    const double y = static_cast<double>( best[i]->offset_ns - best.back()->offset_ns );
+    sx += x; sy += y; sxx += x*x; sxy += x*y;
+    min_x = std::min( min_x, best[i]->remote_ns );
+    max_x = std::max( max_x, best[i]->remote_ns );
+  }
+  const double n = static_cast<double>( best.size() );
+  double b = 0.0;
+  if ( best.size() >= 2 && (max_x - min_x) > min_drift_span_ns )
+  {
+    const double den = n*sxx - sx*sx;
+    if ( den > 0 )
+      b = std::max( -max_drift, std::min( max_drift, (n*sxy - sx*sy) / den ) );
+  }
+  const double a = (sy - b*sx) / n;
+
+  ref_remote_ns_ = ref;
+  offset_ns_ = best.back()->offset_ns + static_cast<int64_t>( a );
+  drift_ = b;
+  min_rtt_ns_ = min_rtt;
+
+  if ( !is_synchronized_ && samples_.size() >= min_samples )
+  {
+    is_synchronized_ = true;
+    std::cout << "Clock synchronized with the robot: offset " << offset_ns_ * 1e-9
+              << " s, round trip " << min_rtt_ns_ * 1e-6 << " ms" << std::endl;
+  }
+}
+
+bool ClockSync::isSynchronized() const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  return is_synchronized_;
+}
+
+rclcpp::Time ClockSync::fromDcmTime( int64_t dcm_time_ms )
+{
+  const int64_t remote_ns = dcm_time_ms * 1000000;
+  if ( !isSynchronized() )
+    return fromRemoteTime( "DCM/Time", remote_ns, helpers::Time::now() );
+
+  boost::mutex::scoped_lock lock( mutex_ );
+  const int64_t host_ns = remote_ns + offset_ns_ + static_cast<int64_t>( drift_ * (remote_ns - ref_remote_ns_) );
+  return rclcpp::Time( host_ns, RCL_ROS_TIME );
+}
+
+rclcpp::Time ClockSync::fromRemoteTime( const std::string& source, int64_t remote_ns, const rclcpp::Time& received )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  std::map<std::string, boost::circular_buffer<int64_t> >::iterator it = remote_offsets_.find( source );
+  if ( it == remote_offsets_.end() )
+  {
+    it = remote_offsets_.insert( std::make_pair( source, boost::circular_buffer<int64_t>( window_size_ ) ) ).first;
+  }
+
+  const int64_t offset = received.nanoseconds() - remote_ns;
+  // a clock reset on the robot invalidates the window
+  if ( !it->second.empty() && std::abs( offset - it->second.back() ) > 10 * max_offset_jump_ns )
+  {
+    it->second.clear();
+  }
+  it->second.push_back( offset );
+
+  // the sample received with the smallest delay bounds the offset best
+  const int64_t min_offset = *std::min_element( it->second.begin(), it->second.end() );
+  return rclcpp::Time( remote_ns + min_offset, RCL_ROS_TIME );
+}
+
+int64_t ClockSync::offsetNs() const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  return offset_ns_;
+}
+
+double ClockSync::drift() const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  return drift_;
+}
+
+int64_t ClockSync::minRoundTripNs() const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  return min_rtt_ns_;
+}
+
+} // tools
+} // naoqi
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef CLOCK_SYNC_HPP
+#define CLOCK_SYNC_HPP
+
+/*
+* STANDARD includes
+*/
+#include <map>
+#include <string>
+
+/*
+* BOOST includes
+*/
+#include <boost/circular_buffer.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+/*
+* ALDEBARAN includes
+*/
+#include <qi/session.hpp>
+#include <qi/anyobject.hpp>
+
+/*
+* ROS includes
+*/
+#include <rclcpp/rclcpp.hpp>
+
+namespace naoqi
+{
+namespace tools
+{
+
+/**
+ * @brief Estimate the offset and drift between the robot clocks and the host
+ * ROS clock, to stamp messages with the time the data was sampled on the robot
+ * instead of the time the RPC returned.
+ *
+ * DCM/Time is probed periodically with ALMemory.getData. Each probe gives an
+ * offset bounded by its round trip time: only the probes with the smallest round
+ * trip of the window are kept (NTP-style filter) and a line is fitted through
+ * them to follow the drift.
+ *
+ * Other robot clocks (image and audio timestamps) can not be probed. Their
+ * offset is estimated passively as the minimum of (reception time - sample time)
+ * over a window, which also includes the minimum transport latency.
+ */
+class ClockSync
+{
+public:
+  ClockSync( const qi::SessionPtr& session, float frequency = 2.0f, size_t window_size = 64 );
+
+  ~ClockSync();
+
+  void start();
+
+  void stop();
+
+  /**
+   * @brief resolve ALMemory again once the session reconnected, the probes
+   * resume if they were running
+   */
+  void reconnect( const qi::SessionPtr& session );
+
+  /**
+   * @brief probe DCM/Time once and keep that offset, for when the periodic
+   * probes are disabled; it is probed again on reconnection only
+   */
+  void latch();
+
+  /**
+   * @brief true once enough probes were done to trust the DCM/Time mapping
+   */
+  bool isSynchronized() const;
+
+  /**
+   * @brief map a DCM/Time, in ms, to the host clock
+   * @note until synchronized, DCM/Time is estimated passively like the clocks
+   * that can not be probed, from the reception time of the samples
+   */
+  rclcpp::Time fromDcmTime( int64_t dcm_time_ms );
+
+  /**
+   * @brief map a timestamp of a robot clock that can not be probed to the host clock
+   * @param source name of the robot clock, each source has its own estimation
+   * @param remote_ns sample time on the robot
+   * @param received host time at which the sample was received
+   */
+  rclcpp::Time fromRemoteTime( const std::string& source, int64_t remote_ns, const rclcpp::Time& received );
+
+  /**
+   * @brief probe DCM/Time once and update the estimation
+   */
+  void probe();
+
+  /** last estimation, for diagnostics */
+  int64_t offsetNs() const;
+  double drift() const;
+  int64_t minRoundTripNs() const;
+
+private:
+  struct Sample
+  {
+    int64_t remote_ns;
+    int64_t offset_ns;
+    int64_t rtt_ns;
+  };
+
+  void loop();
+
+  void estimate();
+
+  qi::AnyObject p_memory_;
+  float frequency_;
+
+  boost::thread thread_;
+  mutable boost::mutex mutex_;
+
+  boost::circular_buffer<Sample> samples_;
+
+  /** host = remote + offset_ns_ + drift_ * (remote - ref_remote_ns_) */
+  int64_t ref_remote_ns_;
+  int64_t offset_ns_;
+  double drift_;
+  int64_t min_rtt_ns_;
+  bool is_synchronized_;
+  bool is_latched_;
+
+  /** passive estimation, per source */
+  size_t window_size_;
+  std::map<std::string, boost::circular_buffer<int64_t> > remote_offsets_;
+
+}; // class
+
+} // tools
+} // naoqi
+
+#endif
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "kinematic_model.hpp"
+
+/*
+* STANDARD includes
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+/*
+* BOOST includes
+*/
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+/*
+* ROS includes
+*/
+#include <urdf/model.h>
+#include <tf2/LinearMath/Quaternion.h>
+#include <tf2/LinearMath/Vector3.h>
+
+namespace naoqi
+{
+namespace tools
+{
+
+namespace
+{
+
+/** bumped whenever the layout of the cache files changes */
+static const uint32_t kFormatVersion = 1;
+static const char kMagic[4] = { 'N', 'Q', 'K', 'M' };
+
+/** compiled models of this process, by hash of the description */
+static boost::mutex models_mutex;
+static std::map<uint64_t, boost::shared_ptr<const KinematicModel> > models;
+
+uint64_t fnv1a( const std::string& data )
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for ( std::string::const_iterator it = data.begin(); it != data.end(); ++it )
+  {
+    hash ^= static_cast<unsigned char>( *it );
+    hash *= 1099511628211ULL;
+  }
+  hash ^= kFormatVersion;
+  hash *= 1099511628211ULL;
+  return hash;
+}
+
+template <typename T>
+void write( std::ostream& stream, const T& value )
+{
+  stream.write( reinterpret_cast<const char*>( &value ), sizeof(T) );
+}
+
+void write( std::ostream& stream, const std::string& value )
+{
+  write( stream, static_cast<uint32_t>( value.size() ) );
+  stream.write( value.data(), value.size() );
+}
+
+template <typename T>
+bool read( std::istream& stream, T& value )
+{
+  return bool( stream.read( reinterpret_cast<char*>( &value ), sizeof(T) ) );
+}
+
+bool read( std::istream& stream, std::string& value )
+{
+  uint32_t size = 0;
+  if ( !read( stream, size ) || size > (1u << 16) )
+    return false;
+  value.resize( size );
+  return size == 0 || bool( stream.read( &value[0], size ) );
+}
+
+void writeSegments( std::ostream& stream, const std::vector<KinematicModel::Segment>& segments )
+{
+  write( stream, static_cast<uint32_t>( segments.size() ) );
+  for ( std::vector<KinematicModel::Segment>::const_iterator it = segments.begin(); it != segments.end(); ++it )
+  {
+    write( stream, it->joint );
+    write( stream, it->parent );
+    write( stream, it->child );
+    write( stream, it->type );
+    write( stream, it->translation );
+    write( stream, it->rotation );
+    write( stream, it->axis );
+    write( stream, it->mimic );
+    write( stream, it->multiplier );
+    write( stream, it->offset );
+  }
+}
+
+/** a mimic joint must refer to a moving joint, it is indexed without check afterwards */
+bool hasValidMimics( const std::vector<KinematicModel::Segment>& segments, size_t moving_size )
+{
+  for ( std::vector<KinematicModel::Segment>::const_iterator it = segments.begin(); it != segments.end(); ++it )
+  {
+    if ( it->mimic < -1 || it->mimic >= static_cast<int64_t>( moving_size ) )
+      return false;
+  }
+  return true;
+}
+
+bool readSegments( std::istream& stream, std::vector<KinematicModel::Segment>& segments )
+{
+  uint32_t size = 0;
+  if ( !read( stream, size ) || size > (1u << 16) )
+    return false;
+  segments.resize( size );
+  for ( std::vector<KinematicModel::Segment>::iterator it = segments.begin(); it != segments.end(); ++it )
+  {
+    if ( !( read( stream, it->joint ) && read( stream, it->parent ) && read( stream, it->child )
+            && read( stream, it->type ) && read( stream, it->translation ) && read( stream, it->rotation )
+            && read( stream, it->axis ) && read( stream, it->mimic )
+            && read( stream, it->multiplier ) && read( stream, it->offset ) ) )
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+KinematicModel::KinematicModel( uint64_t hash ):
+  hash_( hash )
+{
+}
+
+std::string KinematicModel::cacheDirectory()
+{
+  const char* home = getenv( "HOME" );
+  return std::string( home ? home : "/tmp" ) + "/.ros/naoqi_driver";
+}
+
+boost::shared_ptr<const KinematicModel> KinematicModel::fromDescription( const std::string& robot_desc )
+{
+  const uint64_t hash = fnv1a( robot_desc );
+
+  boost::mutex::scoped_lock lock( models_mutex );
+  std::map<uint64_t, boost::shared_ptr<const KinematicModel> >::const_iterator found = models.find( hash );
+  if ( found != models.end() )
+  {
+    return found->second;
+  }
+
+  std::ostringstream file_name;
+  file_name << "kinematic_model_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+  const std::string path = cacheDirectory() + "/" + file_name.str();
+
+  boost::shared_ptr<KinematicModel> model( new KinematicModel( hash ) );
+  if ( model->load( path ) )
+  {
+    std::cout << "kinematic model loaded from " << path << std::endl;
+  }
+  else
+  {
+    if ( !model->compile( robot_desc ) )
+    {
+      std::cerr << "failed to compile the kinematic model of the robot description" << std::endl;
+      return boost::shared_ptr<const KinematicModel>();
+    }
+    if ( model->save( path ) )
+    {
+      std::cout << "kinematic model compiled and cached in " << path << std::endl;
+    }
+  }
+
+  models[hash] = model;
+  return model;
+}
+
+int KinematicModel::jointIndex( const std::string& joint ) const
+{
+  for ( size_t i=0; i<moving_.size(); ++i )
+  {
+    if ( moving_[i].joint == joint )
+      return i;
+  }
+  return -1;
+}
+
+void KinematicModel::computeTransform( const Segment& segment, double position, geometry_msgs::msg::Transform& transform )
+{
+  const tf2::Quaternion origin( segment.rotation[0], segment.rotation[1], segment.rotation[2], segment.rotation[3] );
+  tf2::Quaternion rotation = origin;
+  tf2::Vector3 translation( segment.translation[0], segment.translation[1], segment.translation[2] );
+
+  if ( segment.type == REVOLUTE )
+  {
+    rotation = origin * tf2::Quaternion( tf2::Vector3( segment.axis[0], segment.axis[1], segment.axis[2] ), position );
+  }
+  else if ( segment.type == PRISMATIC )
+  {
+    translation += tf2::quatRotate( origin, tf2::Vector3( segment.axis[0], segment.axis[1], segment.axis[2] ) * position );
+  }
+
+  transform.translation.x = translation.x();
+  transform.translation.y = translation.y();
+  transform.translation.z = translation.z();
+  transform.rotation.x = rotation.x();
+  transform.rotation.y = rotation.y();
+  transform.rotation.z = rotation.z();
+  transform.rotation.w = rotation.w();
+}
+
+bool KinematicModel::compile( const std::string& robot_desc )
+{
+  urdf::Model model;
+  if ( !model.initString( robot_desc ) )
+  {
+    return false;
+  }
+
+  moving_.clear();
+  fixed_.clear();
+  // joints_ is sorted by name, so is moving_
+  for ( std::map<std::string, urdf::JointSharedPtr>::const_iterator it = model.joints_.begin(); it != model.joints_.end(); ++it )
+  {
+    const urdf::Joint& joint = *it->second;
+    Segment segment;
+    segment.joint = joint.name;
+    segment.parent = joint.parent_link_name;
+    segment.child = joint.child_link_name;
+
+    const urdf::Pose& origin = joint.parent_to_joint_origin_transform;
+    segment.translation[0] = origin.position.x;
+    segment.translation[1] = origin.position.y;
+    segment.translation[2] = origin.position.z;
+    segment.rotation[0] = origin.rotation.x;
+    segment.rotation[1] = origin.rotation.y;
+    segment.rotation[2] = origin.rotation.z;
+    segment.rotation[3] = origin.rotation.w;
+    segment.axis[0] = joint.axis.x;
+    segment.axis[1] = joint.axis.y;
+    segment.axis[2] = joint.axis.z;
+    segment.mimic = -1;
+    segment.multiplier = 1.0;
+    segment.offset = 0.0;
+
+    switch ( joint.type )
+    {
+    case urdf::Joint::REVOLUTE:
+    case urdf::Joint::CONTINUOUS:
+      segment.type = REVOLUTE;
+      moving_.push_back( segment );
+      break;
+    case urdf::Joint::PRISMATIC:
+      segment.type = PRISMATIC;
+      moving_.push_back( segment );
+      break;
+    default:
+      // floating and planar joints are not moved by joint states, like in kdl_parser
+      segment.type = FIXED;
+      fixed_.push_back( segment );
+      break;
+    }
+  }
+
+  // resolve the mimic joints once the moving joints are indexed
+  for ( std::vector<Segment>::iterator it = moving_.begin(); it != moving_.end(); ++it )
+  {
+    const urdf::JointConstSharedPtr& joint = model.getJoint( it->joint );
+    if ( joint && joint->mimic )
+    {
+      it->mimic = jointIndex( joint->mimic->joint_name );
+      it->multiplier = joint->mimic->multiplier;
+      it->offset = joint->mimic->offset;
+    }
+  }
+  return true;
+}
+
+bool KinematicModel::load( const std::string& path )
+{
+  std::ifstream stream( path.c_str(), std::ios::binary );
+  if ( !stream )
+  {
+    return false;
+  }
+
+  char magic[4];
+  uint32_t version = 0;
+  uint64_t hash = 0;
+  if ( !stream.read( magic, sizeof(magic) ) || !std::equal( magic, magic + 4, kMagic )
+       || !read( stream, version ) || version != kFormatVersion
+       || !read( stream, hash ) || hash != hash_ )
+  {
+    return false;
+  }
+
+  if ( !readSegments( stream, moving_ ) || !readSegments( stream, fixed_ )
+       || !hasValidMimics( moving_, moving_.size() ) || !hasValidMimics( fixed_, moving_.size() ) )
+  {
+    std::cerr << "ignoring corrupted kinematic model " << path << std::endl;
+    moving_.clear();
+    fixed_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool KinematicModel::save( const std::string& path ) const
+{
+  try {
+    boost::filesystem::create_directories( boost::filesystem::path( path ).parent_path() );
+
+    // written aside under a unique name and renamed, so that another driver
+    // neither reads half a file nor writes the same temporary one
+    const boost::filesystem::path tmp_path = boost::filesystem::unique_path( path + ".%%%%-%%%%-%%%%.tmp" );
+    {
+      std::ofstream stream( tmp_path.string().c_str(), std::ios::binary | std::ios::trunc );
+      stream.write( kMagic, sizeof(kMagic) );
+      write( stream, kFormatVersion );
+      write( stream, hash_ );
+      writeSegments( stream, moving_ );
+      writeSegments( stream, fixed_ );
+      if ( !stream )
+      {
+        stream.close();
+        boost::filesystem::remove( tmp_path );
+        return false;
+      }
+    }
+    boost::filesystem::rename( tmp_path, path );
+  } catch (const std::exception& e) {
+    std::cerr << "could not cache the kinematic model in " << path << ": " << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // tools
+} // naoqi
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef KINEMATIC_MODEL_HPP
+#define KINEMATIC_MODEL_HPP
+
+/*
+* STANDARD includes
+*/
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+* BOOST includes
+*/
+#include <boost/shared_ptr.hpp>
+
+/*
+* ROS includes
+*/
+#include <geometry_msgs/msg/transform.hpp>
+
+namespace naoqi
+{
+namespace tools
+{
+
+/**
+ * @brief Kinematic tree of the robot description, flattened once into
+ * arrays of segments (joint origin, axis and mimic) so that computing the
+ * transforms of a tick does not walk a tree.
+ * The compiled model is kept in memory and on disk, keyed by a hash of the
+ * URDF, so the XML is only parsed when the description changes.
+ */
+class KinematicModel
+{
+public:
+  enum JointType
+  {
+    FIXED = 0,
+    REVOLUTE = 1,
+    PRISMATIC = 2
+  };
+
+  struct Segment
+  {
+    std::string joint;
+    std::string parent;
+    std::string child;
+    uint8_t type;
+    /** joint origin in the parent frame */
+    double translation[3];
+    double rotation[4];
+    /** joint axis in the joint frame */
+    double axis[3];
+    /** index in moving() of the mimicked joint, -1 if not a mimic joint */
+    int32_t mimic;
+    double multiplier;
+    double offset;
+  };
+
+  /**
+   * @brief compiled model of a robot description, read from the disk cache
+   * when possible, compiled and stored in it otherwise
+   * @return null if the description cannot be parsed
+   */
+  static boost::shared_ptr<const KinematicModel> fromDescription( const std::string& robot_desc );
+
+  /**
+   * @brief directory of the compiled models, $HOME/.ros/naoqi_driver
+   */
+  static std::string cacheDirectory();
+
+  /** segments with a moving joint, sorted by joint name */
+  inline const std::vector<Segment>& moving() const
+  {
+    return moving_;
+  }
+
+  /** segments with a fixed joint */
+  inline const std::vector<Segment>& fixed() const
+  {
+    return fixed_;
+  }
+
+  inline uint64_t hash() const
+  {
+    return hash_;
+  }
+
+  /**
+   * @brief index of a moving joint in moving(), -1 if unknown
+   */
+  int jointIndex( const std::string& joint ) const;
+
+  /**
+   * @brief transform from the parent to the child frame of a segment for
+   * the given joint position
+   */
+  static void computeTransform( const Segment& segment, double position, geometry_msgs::msg::Transform& transform );
+
+private:
+  KinematicModel( uint64_t hash );
+
+  bool compile( const std::string& robot_desc );
+  bool load( const std::string& path );
+  bool save( const std::string& path ) const;
+
+  uint64_t hash_;
+  std::vector<Segment> moving_;
+  std::vector<Segment> fixed_;
+};
+
+} // tools
+} // naoqi
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef PHASE_TIMER_HPP
+#define PHASE_TIMER_HPP
+
+/*
+* STANDARD includes
+*/
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace naoqi
+{
+namespace tools
+{
+
+/**
+ * @brief Wall time spent in consecutive phases, to report where startup time goes
+ */
+class PhaseTimer
+{
+public:
+  PhaseTimer( const std::string& name ):
+    name_( name ),
+    start_( std::chrono::steady_clock::now() ),
+    last_( start_ )
+  {}
+
+  /**
+   * @brief close the phase started at the previous mark
+   */
+  inline void mark( const std::string& phase )
+  {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    phases_.push_back( std::make_pair( phase, std::chrono::duration<double, std::milli>( now - last_ ).count() ) );
+    last_ = now;
+  }
+
+  inline void report() const
+  {
+    std::cout << name_ << " timing:" << std::endl;
+    for ( std::vector<std::pair<std::string, double> >::const_iterator it = phases_.begin(); it != phases_.end(); ++it )
+    {
+      std::cout << "  " << it->first << ": " << it->second << " ms" << std::endl;
+    }
+    std::cout << "  total: " << std::chrono::duration<double, std::milli>( last_ - start_ ).count() << " ms" << std::endl;
+  }
+
+private:
+  std::string name_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point last_;
+  std::vector<std::pair<std::string, double> > phases_;
+}; // class
+
+} // tools
+} // naoqi
+
+#endif
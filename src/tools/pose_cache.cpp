@@ -0,0 +1,65 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "pose_cache.hpp"
+#include "../helpers/driver_helpers.hpp"
+#include <naoqi_driver/ros_helpers.hpp>
+
+namespace naoqi
+{
+namespace tools
+{
+
+PoseCache::PoseCache( const qi::SessionPtr& session, float max_age ):
+  p_motion_( helpers::driver::getService( session, "ALMotion" ) ),
+  max_age_( max_age ),
+  has_request_( false ),
+  request_ns_( 0 )
+{
+}
+
+qi::Future<std::vector<float> > PoseCache::getTorsoPose( rclcpp::Time& requested )
+{
+  static const int FRAME_WORLD = 1;
+  const int64_t now_ns = helpers::Time::now().nanoseconds();
+
+  boost::mutex::scoped_lock lock( mutex_ );
+  // a request still in flight is reused, only a failed one is issued again
+  if ( !has_request_
+       || ( request_.isFinished() && request_.hasError() )
+       || now_ns - request_ns_ > static_cast<int64_t>( max_age_ * 1e9 ) )
+  {
+    request_ = p_motion_.async<std::vector<float> >( "getPosition", "Torso", FRAME_WORLD, true );
+    request_ns_ = now_ns;
+    has_request_ = true;
+  }
+  requested = rclcpp::Time( request_ns_, RCL_ROS_TIME );
+  return request_;
+}
+
+void PoseCache::reconnect( const qi::SessionPtr& session )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  p_motion_ = helpers::driver::getService( session, "ALMotion" );
+  has_request_ = false;
+}
+
+} // tools
+} // naoqi
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef POSE_CACHE_HPP
+#define POSE_CACHE_HPP
+
+/*
+* STANDARD includes
+*/
+#include <vector>
+
+/*
+* BOOST includes
+*/
+#include <boost/thread/mutex.hpp>
+
+/*
+* ALDEBARAN includes
+*/
+#include <qi/session.hpp>
+#include <qi/anyobject.hpp>
+
+/*
+* ROS includes
+*/
+#include <rclcpp/time.hpp>
+
+namespace naoqi
+{
+namespace tools
+{
+
+/**
+ * @brief Share the torso pose in the world frame between the converters of a session.
+ * A request issued less than max_age ago, finished or still in flight, is reused
+ * instead of calling ALMotion.getPosition again.
+ */
+class PoseCache
+{
+public:
+  PoseCache( const qi::SessionPtr& session, float max_age );
+
+  /**
+   * @brief torso pose in the world frame (x, y, z, wx, wy, wz), as given by
+   * ALMotion.getPosition("Torso", FRAME_WORLD, true)
+   * @param requested set to the host time the returned request was issued at,
+   * up to max_age before now when a request is reused, to stamp the pose with
+   */
+  qi::Future<std::vector<float> > getTorsoPose( rclcpp::Time& requested );
+
+  /**
+   * @brief resolve ALMotion again once the session reconnected
+   */
+  void reconnect( const qi::SessionPtr& session );
+
+  inline float maxAge() const
+  {
+    return max_age_;
+  }
+
+private:
+  qi::AnyObject p_motion_;
+  float max_age_;
+
+  boost::mutex mutex_;
+  bool has_request_;
+  qi::Future<std::vector<float> > request_;
+  /** host time at which request_ was issued */
+  int64_t request_ns_;
+
+}; // class
+
+} // tools
+} // naoqi
+
+#endif
@@ -22,6 +22,7 @@
 */
 #include "robot_description.hpp"
 #include "../helpers/filesystem_helpers.hpp"
+#include <naoqi_driver/ros_helpers.hpp>
 
 namespace naoqi{
 
@@ -64,11 +65,13 @@ std::string getRobotDescription( const robot::Robot& robot){
 rclcpp::Publisher<std_msgs::msg::String>::SharedPtr
 publishRobotDescription(rclcpp::Node* node, const robot::Robot& robot_type) {
   static const auto topic = "robot_description";
+  // Transient local is similar to latching in ROS 1.
+  const rclcpp::QoS qos = helpers::Node::qos(topic, rclcpp::QoS(1).transient_local());
   rclcpp::Publisher<std_msgs::msg::String>::SharedPtr description_pub =
     node->create_publisher<std_msgs::msg::String>(
       topic,
-      // Transient local is similar to latching in ROS 1.
-      rclcpp::QoS(1).transient_local()
+      qos,
+      helpers::Node::publisher_options(qos)
     );
 
   std::string robot_desc = getRobotDescription(robot_type);
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+/*
+* STANDARD includes
+*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+namespace naoqi
+{
+namespace tools
+{
+
+/**
+ * @brief Running count, mean, root mean square and maximum of a series of
+ * values, without keeping the values
+ */
+class RunningStats
+{
+public:
+  RunningStats()
+  {
+    reset();
+  }
+
+  inline void add( double value )
+  {
+    ++count_;
+    sum_ += value;
+    sum_sq_ += value * value;
+    max_ = (count_ == 1) ? value : std::max( max_, value );
+  }
+
+  inline void reset()
+  {
+    count_ = 0;
+    sum_ = 0.0;
+    sum_sq_ = 0.0;
+    max_ = 0.0;
+  }
+
+  inline size_t count() const
+  {
+    return count_;
+  }
+
+  inline double mean() const
+  {
+    return count_ ? sum_ / count_ : 0.0;
+  }
+
+  inline double rms() const
+  {
+    return count_ ? std::sqrt( sum_sq_ / count_ ) : 0.0;
+  }
+
+  inline double max() const
+  {
+    return max_;
+  }
+
+private:
+  size_t count_;
+  double sum_;
+  double sum_sq_;
+  double max_;
+}; // class
+
+/**
+ * @brief Rate limit of the statistics summaries, which are logged at debug
+ * level once per period and then reset by their owner
+ */
+class StatsReport
+{
+public:
+  StatsReport( std::chrono::seconds period = std::chrono::seconds( 60 ) ):
+    period_( period ),
+    last_( std::chrono::steady_clock::now() )
+  {
+  }
+
+  /** true at most once per period, the caller then logs and resets its statistics */
+  inline bool due()
+  {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if ( now - last_ < period_ )
+      return false;
+    last_ = now;
+    return true;
+  }
+
+private:
+  std::chrono::seconds period_;
+  std::chrono::steady_clock::time_point last_;
+}; // class
+
+} // tools
+} // naoqi
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/*
+* LOCAL includes
+*/
+#include "transform_cache.hpp"
+
+/*
+* STANDARD includes
+*/
+#include <cstdlib>
+
+/*
+* BOOST includes
+*/
+#include <boost/chrono.hpp>
+
+namespace naoqi
+{
+namespace tools
+{
+
+TransformCache::TransformCache( size_t depth ):
+  depth_( depth ),
+  next_listener_id_( 0 )
+{
+}
+
+void TransformCache::registerInterest( const std::string& target, const std::string& source )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  const FramePair pair( target, source );
+  if ( interests_[pair]++ == 0 )
+  {
+    rings_.insert( std::make_pair( pair, Ring( depth_ ) ) );
+  }
+}
+
+void TransformCache::releaseInterest( const std::string& target, const std::string& source )
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  const FramePair pair( target, source );
+  std::map<FramePair, size_t>::iterator it = interests_.find( pair );
+  if ( it == interests_.end() )
+    return;
+  if ( --it->second == 0 )
+  {
+    // the transforms kept so far would be stale when needed again
+    interests_.erase( it );
+    rings_.erase( pair );
+  }
+}
+
+bool TransformCache::hasInterest() const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  return !rings_.empty();
+}
+
+void TransformCache::update( const helpers::transform::TransformTable& table, const rclcpp::Time& stamp )
+{
+  {
+    boost::mutex::scoped_lock lock( mutex_ );
+    for ( std::map<FramePair, Ring>::iterator it = rings_.begin(); it != rings_.end(); ++it )
+    {
+      tf2::Transform transform;
+      if ( !table.lookup( it->first.first, it->first.second, transform ) )
+        continue;
+
+      geometry_msgs::msg::TransformStamped msg;
+      msg.header.stamp = stamp;
+      msg.header.frame_id = it->first.first;
+      msg.child_frame_id = it->first.second;
+      helpers::transform::toMsg( transform, msg.transform );
+      it->second.push_back( msg );
+    }
+  }
+  updated_.notify_all();
+
+  // called on a copy without the lock, so that a listener can add or remove
+  // listeners, even from under its own locks
+  std::map<size_t, Listener> listeners;
+  {
+    boost::mutex::scoped_lock lock( listeners_mutex_ );
+    listeners = listeners_;
+  }
+  for ( std::map<size_t, Listener>::const_iterator it = listeners.begin(); it != listeners.end(); ++it )
+  {
+    it->second( stamp );
+  }
+}
+
+size_t TransformCache::addListener( const Listener& listener )
+{
+  boost::mutex::scoped_lock lock( listeners_mutex_ );
+  listeners_[next_listener_id_] = listener;
+  return next_listener_id_++;
+}
+
+void TransformCache::removeListener( size_t id )
+{
+  boost::mutex::scoped_lock lock( listeners_mutex_ );
+  listeners_.erase( id );
+}
+
+bool TransformCache::lookupLatest( const std::string& target, const std::string& source,
+                                   geometry_msgs::msg::TransformStamped& transform ) const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  std::map<FramePair, Ring>::const_iterator it = rings_.find( FramePair( target, source ) );
+  if ( it == rings_.end() || it->second.empty() )
+    return false;
+  transform = it->second.back();
+  return true;
+}
+
+bool TransformCache::lookup( const std::string& target, const std::string& source, const rclcpp::Time& time,
+                             geometry_msgs::msg::TransformStamped& transform ) const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  std::map<FramePair, Ring>::const_iterator it = rings_.find( FramePair( target, source ) );
+  if ( it == rings_.end() || it->second.empty() )
+    return false;
+
+  const int64_t time_ns = time.nanoseconds();
+  Ring::const_iterator best = it->second.begin();
+  for ( Ring::const_iterator sample = it->second.begin(); sample != it->second.end(); ++sample )
+  {
+    if ( std::abs( rclcpp::Time( sample->header.stamp ).nanoseconds() - time_ns )
+         < std::abs( rclcpp::Time( best->header.stamp ).nanoseconds() - time_ns ) )
+    {
+      best = sample;
+    }
+  }
+  transform = *best;
+  return true;
+}
+
+bool TransformCache::waitForTransform( const std::string& target, const std::string& source, double timeout ) const
+{
+  boost::mutex::scoped_lock lock( mutex_ );
+  const boost::chrono::steady_clock::time_point deadline =
+      boost::chrono::steady_clock::now() + boost::chrono::milliseconds( static_cast<int>(timeout * 1000) );
+  while ( true )
+  {
+    std::map<FramePair, Ring>::const_iterator it = rings_.find( FramePair( target, source ) );
+    if ( it != rings_.end() && !it->second.empty() )
+      return true;
+    if ( updated_.wait_until( lock, deadline ) == boost::cv_status::timeout )
+      return false;
+  }
+}
+
+} // tools
+} // naoqi
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2015 Aldebaran
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef TRANSFORM_CACHE_HPP
+#define TRANSFORM_CACHE_HPP
+
+/*
+* STANDARD includes
+*/
+#include <map>
+#include <string>
+#include <utility>
+
+/*
+* BOOST includes
+*/
+#include <boost/circular_buffer.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+/*
+* ROS includes
+*/
+#include <rclcpp/rclcpp.hpp>
+#include <geometry_msgs/msg/transform_stamped.hpp>
+
+/*
+* LOCAL includes
+*/
+#include "../helpers/transform_helpers.hpp"
+
+namespace naoqi
+{
+namespace tools
+{
+
+/**
+ * @brief Transforms needed by the driver itself.
+ * Instead of filling a whole tf2 buffer on every joint states tick, the
+ * internal consumers register the frame pairs they need and only those are
+ * kept, in a small ring per pair.
+ */
+class TransformCache
+{
+public:
+  TransformCache( size_t depth = 10 );
+
+  /**
+   * @brief keep the transform of source in target from now on,
+   * until each registration is released
+   */
+  void registerInterest( const std::string& target, const std::string& source );
+
+  /**
+   * @brief stop keeping the pair once no consumer needs it anymore
+   */
+  void releaseInterest( const std::string& target, const std::string& source );
+
+  /**
+   * @brief true if a consumer needs a pair, the transforms of a tick are only indexed then
+   */
+  bool hasInterest() const;
+
+  /**
+   * @brief store the registered pairs computed from the transforms of one tick
+   */
+  void update( const helpers::transform::TransformTable& table, const rclcpp::Time& stamp );
+
+  /**
+   * @brief latest transform of source in target
+   * @return false if the pair was never computed
+   */
+  bool lookupLatest( const std::string& target, const std::string& source,
+                     geometry_msgs::msg::TransformStamped& transform ) const;
+
+  /**
+   * @brief transform of source in target closest to the given time
+   */
+  bool lookup( const std::string& target, const std::string& source, const rclcpp::Time& time,
+               geometry_msgs::msg::TransformStamped& transform ) const;
+
+  /**
+   * @brief wait until the pair was computed at least once
+   */
+  bool waitForTransform( const std::string& target, const std::string& source, double timeout ) const;
+
+  typedef boost::function<void(const rclcpp::Time&)> Listener;
+
+  /**
+   * @brief call the listener after each update, from the thread of the converter,
+   * a listener may remove itself when called, and may still be called by an
+   * update in progress right after it was removed
+   * @return id to give to removeListener
+   */
+  size_t addListener( const Listener& listener );
+  void removeListener( size_t id );
+
+private:
+  typedef std::pair<std::string, std::string> FramePair;
+  typedef boost::circular_buffer<geometry_msgs::msg::TransformStamped> Ring;
+
+  size_t depth_;
+  mutable boost::mutex mutex_;
+  mutable boost::condition_variable updated_;
+  std::map<FramePair, Ring> rings_;
+  /** registrations of each pair in rings_ */
+  std::map<FramePair, size_t> interests_;
+
+  boost::mutex listeners_mutex_;
+  std::map<size_t, Listener> listeners_;
+  size_t next_listener_id_;
+
+}; // class
+
+} // tools
+} // naoqi
+
+#endif